@@ -0,0 +1,108 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include "Arena.h"
+
+
+Arena::Pools Arena::defaults;
+thread_local Arena::Pools* Arena::pools = &Arena::defaults;
+thread_local Arena* Arena::bound = nullptr;
+thread_local uint32_t Arena::boundId = 0;
+
+Arena::Arena()
+    : current(0), cursor(nullptr), end(nullptr), filled(0) {  }
+
+Arena::~Arena() {
+    for (Block& block : blocks)
+        std::free(block.memory);
+}
+
+void Arena::nextBlock(size_t size) {
+    if (cursor)
+        filled += blocks[current].size;
+
+    // Reuse blocks from before the last reset
+    if (cursor)
+        current++;
+    while (current < blocks.size() && blocks[current].size < size) {
+        filled += blocks[current].size;
+        current++;
+    }
+
+    if (current == blocks.size()) {
+        const size_t blockSize = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+        char* memory = static_cast<char*>(std::malloc(blockSize));
+        if (!memory)
+            throw std::bad_alloc();
+        blocks.push_back({ memory, blockSize });
+    }
+
+    cursor = blocks[current].memory;
+    end = cursor + blocks[current].size;
+}
+
+void Arena::reset() {
+    current = 0;
+    filled = 0;
+    cursor = nullptr;
+    end = nullptr;
+}
+
+size_t Arena::getUsed() {
+    if (!cursor)
+        return filled;
+    return filled + (cursor - blocks[current].memory);
+}
+
+size_t Arena::getReserved() {
+    size_t reserved = 0;
+    for (Block& block : blocks)
+        reserved += block.size;
+    return reserved;
+}
+
+void Arena::reserve(uint32_t count) {
+    for (vector<unique_ptr<Arena>>& pool : pools->arenas)
+        while (pool.size() < count)
+            pool.push_back(std::make_unique<Arena>());
+}
+
+void Arena::bind(uint32_t id) {
+    reserve(id + 1);
+    bound = pools->arenas[pools->active][id].get();
+    boundId = id;
+}
+
+void Arena::bind(Pools* group, uint32_t id) {
+    pools = group ? group : &defaults;
+    bind(id);
+}
+
+Arena& Arena::local() {
+    return *bound;
+}
+
+void Arena::resetAll() {
+    for (vector<unique_ptr<Arena>>& pool : pools->arenas)
+        for (unique_ptr<Arena>& arena : pool)
+            arena->reset();
+}
+
+void Arena::swapPools() {
+    pools->active ^= 1;
+    bind(boundId);
+}
+
+void Arena::resetStandby() {
+    for (unique_ptr<Arena>& arena : pools->arenas[pools->active ^ 1])
+        arena->reset();
+}
+
+size_t Arena::getTotalUsed() {
+    size_t used = 0;
+    for (unique_ptr<Arena>& arena : pools->arenas[pools->active])
+        used += arena->getUsed();
+    return used;
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include <stdint.h>
+#include <cstdlib>
+#include <vector>
+#include <memory>
+#include <new>
+
+using std::vector;
+using std::unique_ptr;
+
+
+/**
+ * Bump allocator for tree memory
+ * Allocation is a pointer bump, everything is released at once by reset()
+ * Objects placed here are never destructed, so they must not own memory
+*/
+class Arena {
+ public:
+    Arena();
+    ~Arena();
+
+    /**
+     * Allocate aligned memory
+    */
+    void* allocate(size_t size, size_t align);
+
+    /**
+     * Allocate uninitialized array
+    */
+    template <typename T>
+    T* allocateArray(size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    /**
+     * Release all allocations, keeps the blocks for reuse
+    */
+    void reset();
+
+    /**
+     * Bytes handed out since last reset
+    */
+    size_t getUsed();
+
+    /**
+     * Bytes held by the arena
+    */
+    size_t getReserved();
+
+    /**
+     * Double buffered arenas of one engine, one arena per worker
+    */
+    struct Pools {
+        vector<unique_ptr<Arena>> arenas[2];
+        uint8_t active = 0;
+    };
+
+    /**
+     * Make sure the pools hold at least count arenas
+     * Not thread safe, call before starting workers
+    */
+    static void reserve(uint32_t count);
+
+    /**
+     * Route the calling threads allocations to arena id of its pools
+    */
+    static void bind(uint32_t id);
+
+    /**
+     * Route the calling threads allocations to arena id of group
+     * nullptr selects the process wide default pools
+    */
+    static void bind(Pools* group, uint32_t id);
+
+    /**
+     * Arena bound to the calling thread
+    */
+    static Arena& local();
+
+    /**
+     * Reset every arena in both pools
+     * Releases all trees, no node may be in use anymore
+    */
+    static void resetAll();
+
+    /**
+     * Make the standby pool active and rebind the calling thread
+     * Memory of the previously active pool stays valid until resetStandby,
+     * so a subtree can be copied over before the rest is released
+    */
+    static void swapPools();
+
+    /**
+     * Reset every arena in the standby pool
+    */
+    static void resetStandby();
+
+    /**
+     * Bytes handed out by the active pool
+    */
+    static size_t getTotalUsed();
+
+ private:
+    /**
+     * Size of a single block
+    */
+    static constexpr size_t BLOCK_SIZE = size_t(64) << 20;
+
+    /**
+     * Move on to the next block which can hold size bytes
+    */
+    void nextBlock(size_t size);
+
+    struct Block {
+        char* memory;
+        size_t size;
+    };
+
+    vector<Block> blocks;
+    size_t current;
+    char* cursor;
+    char* end;
+
+    /**
+     * Bytes in blocks before the current one
+    */
+    size_t filled;
+
+    static Pools defaults;
+    static thread_local Pools* pools;
+    static thread_local Arena* bound;
+    static thread_local uint32_t boundId;
+};
+
+
+inline void* Arena::allocate(size_t size, size_t align) {
+    uintptr_t address = (reinterpret_cast<uintptr_t>(cursor) + align - 1) &
+        ~(uintptr_t(align) - 1);
+
+    if (address + size > reinterpret_cast<uintptr_t>(end)) {
+        nextBlock(size + align);
+        address = (reinterpret_cast<uintptr_t>(cursor) + align - 1) &
+            ~(uintptr_t(align) - 1);
+    }
+
+    cursor = reinterpret_cast<char*>(address + size);
+    return reinterpret_cast<void*>(address);
+}
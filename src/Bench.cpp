@@ -0,0 +1,235 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <chrono> //NOLINT
+
+#include <sys/resource.h>
+
+#include "Randomizer.h"
+#include "State.h"
+#include "Config.h"
+#include "Node.h"
+#include "Arena.h"
+#include "Rollout.h"
+#include "Utilities.h"
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+using std::ostringstream;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+
+/**
+ * Seeded benchmark workloads
+ * Prints a single JSON object so runs can be compared across builds
+*/
+
+const uint64_t SEED = 0x5eed;
+
+/**
+ * Stones placed before the midgame workloads
+*/
+const uint8_t OPENING_MOVES = 20;
+
+double seconds(steady_clock::time_point start) {
+    return duration<double>(steady_clock::now() - start).count();
+}
+
+/**
+ * Deterministic non terminal position
+ * Stones are scattered around the center
+*/
+template <uint8_t Size>
+State<Size> midgame() {
+    Randomizer::initialize(SEED, 1);
+    State<Size> state;
+    const uint8_t center = Size / 2;
+    while (state.getEmpty() > Size * Size - OPENING_MOVES) {
+        const uint8_t x = center - 3 + Randomizer::randomInt<uint8_t>(7);
+        const uint8_t y = center - 3 + Randomizer::randomInt<uint8_t>(7);
+        if (!state.isEmpty(x, y))
+            continue;
+        State<Size> next(state);
+        next.action(x, y);
+        if (!next.terminal())
+            state = next;
+    }
+    return state;
+}
+
+/**
+ * Replay precomputed random games
+ * Measures State::action including the five in a row check
+*/
+template <uint8_t Size>
+void benchAction(ostringstream& json) {
+    const uint32_t games = 20000;
+
+    // Move orders are drawn up front so only State<Size> is timed
+    Randomizer::initialize(SEED, 2);
+    vector<vector<Index<Size>>> orders;
+    for (uint32_t i = 0; i < 64; i++) {
+        State<Size> state;
+        vector<Index<Size>> order = state.possible();
+        Randomizer::shuffle(order.data(), order.data() + order.size());
+        orders.push_back(order);
+    }
+
+    uint64_t actions = 0;
+    uint32_t results[3] = { 0, 0, 0 };
+    const auto start = steady_clock::now();
+    for (uint32_t i = 0; i < games; i++) {
+        const vector<Index<Size>>& order = orders[i % orders.size()];
+        State<Size> state;
+        for (Index<Size> j = 0; !state.terminal(); j++) {
+            state.action(order[j]);
+            actions++;
+        }
+        results[state.getResult()]++;
+    }
+    const double time = seconds(start);
+
+    json << "  \"state_action\": { \"actions_per_sec\": " << actions / time
+         << ", \"games_per_sec\": " << games / time
+         << ", \"p0\": " << results[0] << ", \"p1\": " << results[1]
+         << ", \"draws\": " << results[2] << " },\n";
+}
+
+/**
+ * Raw playouts from the midgame position without tree overhead
+*/
+template <uint8_t Size>
+void benchRollout(ostringstream& json) {
+    const uint32_t playouts = 200000;
+
+    State<Size> root = midgame<Size>();
+    vector<Index<Size>> actions = root.possible();
+    Randomizer::initialize(SEED, 3);
+    Randomizer::shuffle(actions.data(), actions.data() + actions.size());
+
+    // Sequential
+    uint32_t results[3] = { 0, 0, 0 };
+    auto start = steady_clock::now();
+    for (uint32_t i = 0; i < playouts; i++) {
+        State<Size> state(root);
+        Index<Size> index = Randomizer::randomInt<Index<Size>>(actions.size());
+        while (!state.terminal()) {
+            if (index == actions.size())
+                index = 0;
+            state.action(actions[index++]);
+        }
+        results[state.getResult()]++;
+    }
+    const double sequential = playouts / seconds(start);
+
+    // Batched
+    uint32_t batched[3] = { 0, 0, 0 };
+    start = steady_clock::now();
+    for (uint32_t i = 0; i < playouts / 32; i++)
+        Rollout<Size>::template simulate<32>(&root, actions.data(),
+            actions.size(), batched);
+    const double lanes = (playouts / 32) * 32 / seconds(start);
+
+    json << "  \"rollout\": { \"sequential_per_sec\": " << sequential
+         << ", \"batched32_per_sec\": " << lanes;
+
+    #ifndef SMALL_STATE
+    // Threat aware
+    uint32_t threats[3] = { 0, 0, 0 };
+    start = steady_clock::now();
+    for (uint32_t i = 0; i < playouts / 32; i++)
+        Rollout<Size>::template simulateThreats<32>(&root, actions.data(),
+            actions.size(), threats);
+    json << ", \"threats_per_sec\": " << (playouts / 32) * 32 / seconds(start)
+         << ", \"threats_p0\": " << threats[0]
+         << ", \"threats_p1\": " << threats[1]
+         << ", \"threats_draws\": " << threats[2];
+    #endif
+
+    json << ", \"p0\": " << results[0] << ", \"p1\": " << results[1]
+         << ", \"draws\": " << results[2] << " },\n";
+}
+
+/**
+ * Full policy and rollout iterations on a single thread
+*/
+template <uint8_t Size>
+void benchSearch(ostringstream& json, const string& name, State<Size> root,
+    uint32_t iterations) {
+    Node<Size>::reset();
+    Arena::resetAll();
+    Randomizer::initialize(SEED, 4);
+
+    Node<Size>* tree = new Node<Size>(root);
+    const auto start = steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) {
+        Node<Size>* node = tree->policy();
+        node->rollout();
+    }
+    const double time = seconds(start);
+
+    json << "  \"" << name << "\": { \"iterations_per_sec\": "
+         << iterations / time
+         << ", \"simulations_per_sec\": " << tree->getVisits() / time
+         << ", \"tt_hitrate\": " << Node<Size>::getTableHitrate()
+         << ", \"tt_occupancy\": " << Node<Size>::getTableOccupancy()
+         << ", \"tt_replacements\": " << Node<Size>::getTableReplacements()
+         << ", \"arena_bytes\": " << Arena::getTotalUsed() << " },\n";
+}
+
+/**
+ * Run every workload on a board of Size
+*/
+template <uint8_t Size>
+void bench() {
+    State<Size>::initZobrist();
+    Node<Size>::reserveTT(uint64_t(TABLE_MEMORY) << 20);
+
+    ostringstream json;
+    json << "{\n";
+    #ifdef SMALL_STATE
+    json << "  \"state\": \"small\",\n";
+    #else
+    json << "  \"state\": \"default\",\n";
+    #endif
+    json << "  \"board_size\": " << static_cast<int>(Size) << ",\n";
+    json << "  \"rollout_lanes\": " << ROLLOUT_LANES << ",\n";
+    json << "  \"state_bytes\": " << sizeof(State<Size>) << ",\n";
+
+    benchAction<Size>(json);
+    benchRollout<Size>(json);
+    benchSearch(json, "search_empty", State<Size>(), 50000);
+    benchSearch(json, "search_midgame", midgame<Size>(), 50000);
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    json << "  \"peak_memory_kb\": " << usage.ru_maxrss << "\n";
+    json << "}\n";
+
+    cout << json.str();
+}
+
+int main(int argc, char** argv) {
+    Randomizer::initialize(SEED);
+    Arena::bind(0);
+
+    // Optional board size argument
+    const int size = argc > 1 ? atoi(argv[1]) : BOARD_SIZE;
+
+    const bool supported = 0 < size && size < 64 &&
+        withBoardSize(size, []<uint8_t Size>() { bench<Size>(); });
+
+    if (!supported) {
+        std::cerr << "Unsupported board size " << size
+            << "! Compiled sizes: " << boardSizes() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include <stdio.h>
+#include <cstring>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "Book.h"
+
+static const char MAGIC[4] = { 'G', 'M', 'B', 'K' };
+static const uint32_t VERSION = 1;
+
+template <uint8_t Size>
+Book<Size>::Book()
+    : mapping(nullptr), bytes(0), entries(nullptr), count(0) {  }
+
+template <uint8_t Size>
+Book<Size>::~Book() {
+    close();
+}
+
+#ifdef _WIN32
+// No memory mapping, Windows builds play without a book
+template <uint8_t Size>
+bool Book<Size>::open(const string&) {
+    return false;
+}
+
+template <uint8_t Size>
+void Book<Size>::close() {  }
+#else
+template <uint8_t Size>
+bool Book<Size>::open(const string& path) {
+    close();
+
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        return false;
+
+    struct stat info;
+    void* data = MAP_FAILED;
+    if (!fstat(file, &info) &&
+        static_cast<uint64_t>(info.st_size) >= sizeof(Header))
+        data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (data == MAP_FAILED)
+        return false;
+
+    // Reject books of other sizes and truncated files
+    const Header* header = static_cast<const Header*>(data);
+    const uint64_t expected = sizeof(Header) +
+        static_cast<uint64_t>(header->count) * sizeof(Entry);
+    if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) ||
+        header->version != VERSION || header->size != Size ||
+        expected > static_cast<uint64_t>(info.st_size)) {
+        munmap(data, info.st_size);
+        return false;
+    }
+
+    mapping = data;
+    bytes = info.st_size;
+    entries = reinterpret_cast<const Entry*>(header + 1);
+    count = header->count;
+    return true;
+}
+
+template <uint8_t Size>
+void Book<Size>::close() {
+    if (mapping)
+        munmap(mapping, bytes);
+    mapping = nullptr;
+    bytes = 0;
+    entries = nullptr;
+    count = 0;
+}
+#endif
+
+template <uint8_t Size>
+bool Book<Size>::lookup(State<Size>* state, index_t* move) {
+    if (!count)
+        return false;
+
+    uint8_t symmetry;
+    const uint64_t hash = state->canonicalHash(&symmetry);
+    const Entry* entry = std::lower_bound(entries, entries + count, hash,
+        [](const Entry& entry, uint64_t hash) { return entry.hash < hash; });
+    if (entry == entries + count || entry->hash != hash ||
+        entry->move >= Size * Size)
+        return false;
+
+    // Back from the canonical orientation
+    const index_t action = Utils<Size>::transform(entry->move,
+        Utils<Size>::inverse(symmetry));
+    if (!state->isEmpty(action))
+        return false;
+
+    *move = action;
+    return true;
+}
+
+template <uint8_t Size>
+uint64_t Book<Size>::getCount() {
+    return count;
+}
+
+template <uint8_t Size>
+bool Book<Size>::write(const string& path, vector<Entry> entries) {
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) {
+            return a.hash != b.hash ? a.hash < b.hash : a.visits > b.visits;
+        });
+
+    Header header;
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.size = Size;
+    header.count = entries.size();
+
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(entries.data(), sizeof(Entry), entries.size(), file) ==
+        entries.size();
+    written &= fclose(file) == 0;
+    return written;
+}
+
+// Explicit template instantiation for compiled board sizes
+#define INSTANTIATE(SIZE) template class Book<SIZE>;
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Config.h"
+#include "State.h"
+
+using std::string;
+using std::vector;
+
+
+/**
+ * Read-only opening book of a board of Size
+ * A header followed by fixed size records sorted by canonical hash,
+ * records of one position by descending visits. Moves are stored for
+ * the canonical orientation, so every symmetric position hits.
+ *
+ * The file is memory mapped, pages are only read when a lookup
+ * touches them, so opening costs no time. Records use the byte order
+ * of the machine which built the book.
+*/
+template <uint8_t Size>
+class Book {
+ public:
+    typedef Index<Size> index_t;
+
+    /**
+     * Book move of a position
+    */
+    struct Entry {
+        uint64_t hash;
+        uint32_t visits;
+        uint16_t move;
+        uint16_t reserved;
+    };
+
+    Book();
+    ~Book();
+
+    Book(const Book&) = delete;
+    Book& operator=(const Book&) = delete;
+
+    /**
+     * Map the book at path, replacing the current one
+     * Returns false if there is no book of Size at path
+    */
+    bool open(const string& path);
+
+    /**
+     * Unmap the book
+    */
+    void close();
+
+    /**
+     * Most visited book move of state, binary search over the records
+     * Returns false if the position is not in the book
+    */
+    bool lookup(State<Size>* state, index_t* move);
+
+    /**
+     * Get the number of records
+    */
+    uint64_t getCount();
+
+    /**
+     * Write entries as a book of Size to path, sorting them first
+     * Returns false if the file could not be written
+    */
+    static bool write(const string& path, vector<Entry> entries);
+
+ private:
+    /**
+     * File header, the records follow right after it
+    */
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t size;
+        uint32_t count;
+    };
+
+    void* mapping;
+    uint64_t bytes;
+    const Entry* entries;
+    uint64_t count;
+};
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+
+#include <chrono> //NOLINT
+
+#include "State.h"
+#include "Config.h"
+#include "Utilities.h"
+#include "Randomizer.h"
+#include "Engine.h"
+#include "Book.h"
+#include "Search.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+using std::chrono::milliseconds;
+
+/**
+ * Builds an opening book from deep searches
+ * Starting from the empty board every position is searched once, its
+ * width most visited moves are stored and followed to the next ply,
+ * the book plays the most visited one. Symmetric positions are
+ * searched only once.
+ *
+ * Arguments are key=value pairs:
+ *   size, depth (plies), width (moves followed per position)
+ *   sims (per position), time (ms per position, replaces sims if set)
+ *   threads, seed, out (file, OPENING_BOOK with size and .bin if unset)
+*/
+
+struct Options {
+    int size = BOARD_SIZE;
+    uint32_t depth = 4;
+    uint32_t width = 3;
+    uint64_t simulations = 200000;
+    int64_t time = 0;
+    uint32_t threads = THREADS;
+    uint64_t seed = 0x5eed;
+    string out;
+};
+
+/**
+ * Search every position up to depth and write the book
+*/
+template <uint8_t Size>
+bool build(const Options& options) {
+    typedef typename Book<Size>::Entry Entry;
+
+    initBoard<Size>();
+
+    vector<Entry> entries;
+    std::unordered_set<uint64_t> searched;
+    vector<State<Size>> positions = { State<Size>() };
+
+    for (uint32_t ply = 0; ply < options.depth; ply++) {
+        vector<State<Size>> next;
+        for (State<Size>& position : positions) {
+            uint8_t symmetry;
+            const uint64_t hash = position.canonicalHash(&symmetry);
+            if (position.terminal() || !searched.insert(hash).second)
+                continue;
+
+            State<Size> played(position);
+            options.time ?
+                MCTS_move(&played, milliseconds(options.time),
+                    options.threads) :
+                MCTS_move(&played, options.simulations, options.threads);
+
+            // Forced wins are played without a tree
+            Node<Size>* best = Engine<Size>::local().tree;
+            if (!best) {
+                entries.push_back({ hash, 0,
+                    Utils<Size>::transform(played.getLast(), symmetry), 0 });
+                continue;
+            }
+
+            // Root moves by visits
+            Node<Size>* root = best->getParent();
+            vector<Node<Size>*> children(root->getChildren(),
+                root->getChildren() + root->getChildCount());
+            std::sort(children.begin(), children.end(),
+                [](Node<Size>* a, Node<Size>* b) {
+                    return a->getVisits() > b->getVisits();
+                });
+            if (children.size() > options.width)
+                children.resize(options.width);
+
+            for (Node<Size>* child : children) {
+                const Index<Size> move = child->getParentAction();
+                entries.push_back({ hash, child->getVisits(),
+                    Utils<Size>::transform(move, symmetry), 0 });
+                next.push_back(position);
+                next.back().action(move);
+            }
+
+            int x, y;
+            Utils<Size>::indexToCords(best->getParentAction(), &x, &y);
+            cerr << "ply " << ply << " position " << searched.size()
+                << " move " << x << "," << y << endl;
+        }
+        positions = std::move(next);
+    }
+
+    const string path = options.out.empty() ?
+        OPENING_BOOK + std::to_string(Size) + ".bin" : options.out;
+    if (!Book<Size>::write(path, entries)) {
+        cerr << "Could not write " << path << "!" << endl;
+        return false;
+    }
+
+    cout << "{ \"board_size\": " << static_cast<int>(Size)
+         << ", \"positions\": " << searched.size()
+         << ", \"entries\": " << entries.size()
+         << ", \"file\": \"" << path << "\" }" << endl;
+    return true;
+}
+
+/**
+ * Apply a key=value argument, false if unknown
+*/
+bool parse(const string& argument, Options* options) {
+    const size_t split = argument.find('=');
+    if (split == string::npos)
+        return false;
+
+    const string key = argument.substr(0, split);
+    const char* value = argument.c_str() + split + 1;
+
+    if (key == "size")
+        options->size = atoi(value);
+    else if (key == "depth")
+        options->depth = atoi(value);
+    else if (key == "width")
+        options->width = std::max(atoi(value), 1);
+    else if (key == "sims")
+        options->simulations = strtoull(value, nullptr, 10);
+    else if (key == "time")
+        options->time = atoll(value);
+    else if (key == "threads")
+        options->threads = atoi(value);
+    else if (key == "seed")
+        options->seed = strtoull(value, nullptr, 10);
+    else if (key == "out")
+        options->out = value;
+    else
+        return false;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (!parse(argv[i], &options)) {
+            cerr << "Unknown argument " << argv[i] << "!" << endl;
+            return 1;
+        }
+    }
+
+    if (options.simulations > MAX_SIMULATIONS) {
+        cerr << "Simulations must be less than " << MAX_SIMULATIONS
+            << "!" << endl;
+        return 1;
+    }
+
+    Randomizer::initialize(options.seed);
+
+    bool written = false;
+    const int size = options.size;
+    const bool supported = 0 < size && size < 64 &&
+        withBoardSize(size, [&]<uint8_t Size>() {
+            written = build<Size>(options);
+        });
+
+    if (!supported) {
+        cerr << "Unsupported board size " << size
+            << "! Compiled sizes: " << boardSizes() << endl;
+        return 1;
+    }
+    return written ? 0 : 1;
+}
@@ -5,18 +5,43 @@
  */
 
 
+#include <stdint.h>
+#include <type_traits>
+
+
 /**
- * Board size
- * Must be between 4 < BOARD_SIZE < 64
+ * Default board size
+ * Must be one of BOARD_SIZES
 */
 #define BOARD_SIZE 15
 
+/**
+ * Board sizes compiled into the binary
+ * Every size gets its own specialized engine, picked at runtime
+ * Each must be between 4 < size < 64
+*/
+#define BOARD_SIZES(SIZE) SIZE(15) SIZE(19)
+
 /**
  * Hard limit of simulations per move
  * If reached, the MCTS will stop and return the best move
- * Needed to prevent overflow of the log table and other optimizations
+ * Keeps the 32 bit visit counters and result deltas from overflowing
+*/
+#define MAX_SIMULATIONS 2'000'000'000
+
+/**
+ * Transposition table memory budget in MB
+ * Rounded down to a power of two, full buckets replace their
+ * least visited entry
+*/
+#define TABLE_MEMORY 256
+
+/**
+ * Enable / Disable symmetry canonical hashing
+ * Positions equal up to rotation or reflection share TT statistics
+ * State keeps eight hashes up to date on every action
 */
-#define MAX_SIMULATIONS 10'000'000
+#define SYMMETRY_HASH
 
 /**
  * Exploration bias
@@ -25,6 +50,90 @@
 */
 #define EXPLORATION_BIAS 1.4142135624
 
+/**
+ * Enable / Disable early stopping of timed searches
+ * Stops once a move wins on the spot or the most visited move can not
+ * be overtaken with the time left at the current simulation rate
+ * Share of the remaining simulations the runner-up could get,
+ * 1 only stops when the move is settled, lower values stop sooner
+*/
+#define EARLY_STOP 1.0
+
+/**
+ * Radius around stones in which the tree expands moves
+ * Rollouts still play on the whole board
+ * 0 expands every empty field, default of every engine, at most 7
+*/
+#define NEIGHBORHOOD 2
+
+/**
+ * Progressive widening
+ * Nodes expand their moves best prior first and may have
+ * 1 + WIDENING * sqrt(visits) children, every rollout lane is a visit
+ * 0 expands every move in random order, default of every engine
+*/
+#define WIDENING 0.05
+
+/**
+ * Opening book read from the working directory if present
+ * The board size and .bin are appended, e.g. book15.bin
+ * Positions in it are played without searching
+*/
+#define OPENING_BOOK "book"
+
+/**
+ * Number of search threads sharing one tree
+ * 0 uses every hardware thread
+*/
+#define THREADS 0
+
+/**
+ * Virtual loss
+ * Losses added per pending simulation on a node
+ * Higher values spread parallel workers over more paths
+*/
+#define VIRTUAL_LOSS 3
+
+/**
+ * Enable / Disable pondering
+ * Keeps searching while waiting for the opponents move
+*/
+#define PONDER
+
+/**
+ * Playouts simulated together per rollout (1, 8, 16 or 32)
+ * Lanes run in SIMD registers, 1 uses the sequential rollout
+ * Every playout counts as a visit
+*/
+#define ROLLOUT_LANES 16
+
+/**
+ * Enable / Disable threat aware rollouts
+ * Rollouts first play the forced moves, completing an own five
+ * or blocking one of the opponent, then continue randomly
+ * Default of every engine, needs the full state and ROLLOUT_LANES > 1
+*/
+// #define THREAT_ROLLOUTS
+
+/**
+ * Threat space search for victories by continuous fours (VCF)
+ * Moves the prover may try before a search, a forced win is
+ * played right away, 0 disables it. Needs the full state
+*/
+#define VCF_ROOT 100000
+
+/**
+ * Moves the prover may try at every new node, a forced win
+ * solves it, 0 disables it, default of every engine
+*/
+#define VCF_NODES 200
+
+/**
+ * Entries of the table remembering positions without VCF
+ * Must be a power of two
+*/
+#define VCF_TABLE 65536
+
 /**
  * Enable / Disable RAVE
 */
@@ -52,11 +161,8 @@
 // #define SMALL_STATE
 
 /**
- * Type to 1D index the board
- * Save memory if [BOARD_SIZE ^ 2] < [2 ^ 16]
+ * Type to 1D index a board of Size
+ * Save memory if [Size ^ 2] < [2 ^ 8]
 */
-#if BOARD_SIZE < 16
-typedef uint8_t index_t;
-#else
-typedef uint16_t index_t;
-#endif
+template <uint8_t Size>
+using Index = std::conditional_t<(Size < 16), uint8_t, uint16_t>;
@@ -4,24 +4,25 @@
 
 #include "Dev.h"
 
-void Analytics::visitsDist(Node* root) {
+template <uint8_t Size>
+void Analytics<Size>::visitsDist(Node<Size>* root) {
     vector<vector<string>> cellValues;
 
     uint32_t maxVisits = 0;
-    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
-        Node* child = root->getChild(i);
+    for (int i = 0; i < Size * Size; i++) {
+        Node<Size>* child = root->getChild(i);
         if (child != nullptr) {
             if (child->getVisits() > maxVisits)
                 maxVisits = child->getVisits();
         }
     }
 
-    for (int i = 0; i < BOARD_SIZE; i++) {
+    for (int i = 0; i < Size; i++) {
         vector<string> row;
-        for (int j = 0; j < BOARD_SIZE; j++) {
+        for (int j = 0; j < Size; j++) {
             index_t index;
-            Utils::cordsToIndex(&index, i, j);
-            Node* child = root->getChild(index);
+            Utils<Size>::cordsToIndex(&index, i, j);
+            Node<Size>* child = root->getChild(index);
             if (child != nullptr) {
                 // Add relative visits in percent with 3 digits padding
                 // The value is a integer from 0 to 999
@@ -37,20 +38,21 @@ void Analytics::visitsDist(Node* root) {
     }
 
     cout << endl << "    < Visits Distribution >" << endl;
-    cout << Utils::cellsToString(cellValues);
+    cout << Utils<Size>::cellsToString(cellValues);
 }
 
-void Analytics::ucbDist(Node* root) {
+template <uint8_t Size>
+void Analytics<Size>::ucbDist(Node<Size>* root) {
     vector<vector<string>> cellValues;
 
     const bool turn = root->getState()->getEmpty() % 2;
 
-    for (int i = 0; i < BOARD_SIZE; i++) {
+    for (int i = 0; i < Size; i++) {
         vector<string> row;
-        for (int j = 0; j < BOARD_SIZE; j++) {
+        for (int j = 0; j < Size; j++) {
             index_t index;
-            Utils::cordsToIndex(&index, i, j);
-            Node* child = root->getChild(index);
+            Utils<Size>::cordsToIndex(&index, i, j);
+            Node<Size>* child = root->getChild(index);
             if (child != nullptr) {
                 // Add relative visits in percent with 3 digits padding
                 // The value is a integer from 0 to 999
@@ -67,21 +69,22 @@ void Analytics::ucbDist(Node* root) {
     }
 
     cout << endl << "    < UCB Distribution >" << endl;
-    cout << Utils::cellsToString(cellValues);
+    cout << Utils<Size>::cellsToString(cellValues);
 }
 
 #ifdef RAVE
-void Analytics::raveDist(Node* root) {
+template <uint8_t Size>
+void Analytics<Size>::raveDist(Node<Size>* root) {
     vector<vector<string>> cellValues;
 
     const bool turn = root->getState()->getEmpty() % 2;
 
-    for (int i = 0; i < BOARD_SIZE; i++) {
+    for (int i = 0; i < Size; i++) {
         vector<string> row;
-        for (int j = 0; j < BOARD_SIZE; j++) {
+        for (int j = 0; j < Size; j++) {
             index_t index;
-            Utils::cordsToIndex(&index, i, j);
-            Node* child = root->getChild(index);
+            Utils<Size>::cordsToIndex(&index, i, j);
+            Node<Size>* child = root->getChild(index);
             if (child != nullptr) {
                 // Add relative visits in percent with 3 digits padding
                 // The value is a integer from 0 to 999
@@ -98,22 +101,23 @@ void Analytics::raveDist(Node* root) {
     }
 
     cout << endl << "    < RAVE Distribution >" << endl;
-    cout << Utils::cellsToString(cellValues);
+    cout << Utils<Size>::cellsToString(cellValues);
 }
 #endif
 
-void Analytics::overview(Node* best) {
+template <uint8_t Size>
+void Analytics<Size>::overview(Node<Size>* best) {
     ostringstream result;
 
     result << "    <";
-    for (index_t i = 0; i < BOARD_SIZE * 2 + 26; i++)
+    for (index_t i = 0; i < Size * 2 + 26; i++)
         result << "-";
     result << ">\n";
 
     int x, y;
-    Utils::indexToCords(best->getParentAction(), &x, &y);
+    Utils<Size>::indexToCords(best->getParentAction(), &x, &y);
 
-    Node* parent = best->getParent();
+    Node<Size>* parent = best->getParent();
     const double simsInMillion = (parent->getVisits() / 1000) / 1000.0;
     const int tRelWins = parent->getScore(best->getEmpty() % 2);
     const int tRelLoss = parent->getScore(!best->getEmpty() % 2);
@@ -123,7 +127,9 @@ void Analytics::overview(Node* best) {
     const int fRelDraw = best->getScore(2);
     const double evaluation = best->qDelta(parent->getEmpty() % 2) /
         static_cast<double>(best->getVisits());
-    const double TT_hitrate = Node::getTableHitrate();
+    const double TT_hitrate = Node<Size>::getTableHitrate();
+    const double TT_occupancy = Node<Size>::getTableOccupancy();
+    const uint64_t TT_replacements = Node<Size>::getTableReplacements();
     const double confidence = (best->getVisits() * 100) /
         static_cast<double>(parent->getVisits());
     const double draw = (best->getScore(2) * 100) /
@@ -139,13 +145,20 @@ void Analytics::overview(Node* best) {
        << " L:" << fRelLoss
        << " D:" << fRelDraw << ")\n";
     result << "TT-Hitrate:  " << TT_hitrate << "%\n";
+    result << "TT-Usage:    " << TT_occupancy << "%"
+        << " (Replaced: " << TT_replacements << ")\n";
     result << "Confidence:  " << confidence << "%\n";
     result << "Draw:        " << draw << "%\n";
 
     result << "    <";
-    for (index_t i = 0; i < BOARD_SIZE * 2 + 26; i++)
+    for (index_t i = 0; i < Size * 2 + 26; i++)
         result << "-";
     result << ">\n";
 
     cout << result.str();
 }
+
+// Explicit template instantiation for compiled board sizes
+#define INSTANTIATE(SIZE) template class Analytics<SIZE>;
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
@@ -25,13 +25,16 @@ using std::endl;
 using std::fixed;
 using std::setprecision;
 
+template <uint8_t Size>
 class Analytics {
  public:
-    static void visitsDist(Node* root);
-    static void ucbDist(Node* root);
-    static void overview(Node* root);
+    typedef Index<Size> index_t;
+
+    static void visitsDist(Node<Size>* root);
+    static void ucbDist(Node<Size>* root);
+    static void overview(Node<Size>* root);
 
     #ifdef RAVE
-    static void raveDist(Node* root);
+    static void raveDist(Node<Size>* root);
     #endif
 };
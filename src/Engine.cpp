@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include "Engine.h"
+
+
+template <uint8_t Size>
+Engine<Size> Engine<Size>::fallback;
+
+template <uint8_t Size>
+thread_local Engine<Size>* Engine<Size>::bound = &Engine<Size>::fallback;
+
+template <uint8_t Size>
+Engine<Size>::Engine()
+    : transposeHits(0), transposeMisses(0),
+      #ifdef RAVE
+      raveVisits(), raveResults(), raveK(K_PARAM),
+      #endif
+      explorationBias(EXPLORATION_BIAS),
+      #ifndef SMALL_STATE
+      #ifdef THREAT_ROLLOUTS
+      threatRollouts(true),
+      #else
+      threatRollouts(false),
+      #endif
+      vcfBudget(VCF_NODES),
+      #endif
+      radius(NEIGHBORHOOD), widening(WIDENING), tree(nullptr) {  }
+
+template <uint8_t Size>
+void Engine<Size>::bind(Engine* engine, uint32_t id) {
+    bound = engine ? engine : &fallback;
+    Arena::bind(bound == &fallback ? nullptr : &bound->pools, id);
+}
+
+template <uint8_t Size>
+Engine<Size>& Engine<Size>::local() {
+    return *bound;
+}
+
+// Explicit template instantiation for compiled board sizes
+#define INSTANTIATE(SIZE) template class Engine<SIZE>;
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include <stdint.h>
+#include <atomic>
+
+#include "Config.h"
+#include "Arena.h"
+#include "TranspositionTable.h"
+#include "ThreatSpace.h"
+#include "Book.h"
+
+using std::atomic;
+
+template <uint8_t Size>
+class Node;
+
+
+/**
+ * Everything one search shares between its workers on a board of Size
+ * Several engines can search in the same process at once, e.g. for
+ * self-play. Every thread works for the engine bound to it, threads
+ * which never bind one share the default engine.
+*/
+template <uint8_t Size>
+class Engine {
+ public:
+    Engine();
+
+    /**
+     * Make engine the one of the calling thread and allocate from its
+     * arenas as worker id, nullptr selects the default engine
+     * The default engine allocates from the default arena pools
+    */
+    static void bind(Engine* engine, uint32_t id = 0);
+
+    /**
+     * Engine bound to the calling thread
+    */
+    static Engine& local();
+
+    /**
+     * Transposition table
+    */
+    TranspositionTable<Size> TT;
+
+    /**
+     * TT hits
+    */
+    atomic<uint32_t> transposeHits;
+    atomic<uint32_t> transposeMisses;
+
+    #ifdef RAVE
+    /**
+     * RAVE table
+    */
+    atomic<uint32_t> raveVisits[Size * Size];
+    atomic<uint32_t> raveResults[Size * Size][3];
+
+    /**
+     * Rave constant, K_PARAM unless changed
+    */
+    float raveK;
+    #endif
+
+    /**
+     * Exploration bias, EXPLORATION_BIAS unless changed
+    */
+    float explorationBias;
+
+    #ifndef SMALL_STATE
+    /**
+     * Use threat aware rollouts, set by THREAT_ROLLOUTS unless changed
+    */
+    bool threatRollouts;
+
+    /**
+     * Prover for forced wins by continuous fours
+    */
+    ThreatSpace<Size> prover;
+
+    /**
+     * Moves the prover may try at new nodes, VCF_NODES unless changed
+    */
+    uint32_t vcfBudget;
+    #endif
+
+    /**
+     * Radius around stones the tree expands, NEIGHBORHOOD unless changed
+    */
+    uint8_t radius;
+
+    /**
+     * Progressive widening factor, WIDENING unless changed
+    */
+    float widening;
+
+    /**
+     * Search tree kept between moves
+     * Root is the position after our last move
+    */
+    Node<Size>* tree;
+
+    /**
+     * Arenas of the search trees
+    */
+    Arena::Pools pools;
+
+    /**
+     * Opening book, empty unless opened
+    */
+    Book<Size> book;
+
+ private:
+    static Engine fallback;
+    static thread_local Engine* bound;
+};
@@ -5,76 +5,248 @@
 
 #include "Node.h"
 
-unordered_map<uint64_t, Statistics*> Node::TT;
+template <uint8_t Size>
+Node<Size>::Node(Statistics<Size>* data, Node* parent)
+    : parent(parent), data(data), children(nullptr), childCount(0),
+      childActions(nullptr), childVisits(nullptr), childDeltas(nullptr),
+      childPending(nullptr), childProofs(nullptr), provenLosses(0),
+      slot(0), proof(UNPROVEN),
+      #ifdef SYMMETRY_HASH
+      frame(0),
+      #endif
+      actions(nullptr) {
 
-double Node::logTable[MAX_SIMULATIONS];
+    // Shuffle actions for faster rollout
+    Arena& arena = Arena::local();
+    actions = arena.allocateArray<index_t>(data->state.getEmpty());
+    actionCount = data->state.possible(actions);
+    Randomizer::shuffle(actions, actions + actionCount);
+
+    // Tree only expands fields near stones, rollouts still use all
+    const Engine<Size>& engine = Engine<Size>::local();
+    index_t near[Size * Size];
+    moveCount = engine.radius ?
+        data->state.neighborhood(near, engine.radius) : 0;
+    if (!moveCount && !engine.widening) {
+        moves = actions;
+        moveCount = actionCount;
+    } else {
+        if (!moveCount) {
+            moveCount = actionCount;
+            std::copy(actions, actions + actionCount, near);
+        }
+        moves = arena.allocateArray<index_t>(moveCount);
+        std::copy(near, near + moveCount, moves);
+        Randomizer::shuffle(moves, moves + moveCount);
+
+        // Expanded from the back, so the best prior goes last
+        // Ties keep the shuffled order
+        if (engine.widening) {
+            uint16_t priors[Size * Size];
+            for (index_t i = 0; i < moveCount; i++)
+                priors[moves[i]] = data->state.prior(moves[i]);
+            std::sort(moves, moves + moveCount,
+                [&priors](index_t a, index_t b) {
+                    return priors[a] < priors[b];
+                });
+        }
+    }
+    untried = moveCount;
+}
 
-uint32_t Node::transposeHits = 0;
-uint32_t Node::transposeMisses = 0;
+template <uint8_t Size>
+Node<Size>::Node(State<Size> state, Node* parent)
+    : Node(new Statistics<Size>(state), parent) {  }
 
-#ifdef RAVE
-uint32_t Node::raveVisits[BOARD_SIZE * BOARD_SIZE];
-uint32_t Node::raveResults[BOARD_SIZE * BOARD_SIZE][3];
-#endif
+template <uint8_t Size>
+Node<Size>::Node(State<Size> state)
+    : Node(state, nullptr) {  }
 
-Node::Node(Statistics* data, Node* parent)
-    : parent(parent), data(data) {
+template <uint8_t Size>
+Node<Size>::Node()
+    : Node(State<Size>()) {  }
+
+template <uint8_t Size>
+Node<Size>::Node(Node* source, Statistics<Size>* data, Node* parent)
+    : parent(parent), data(data), children(nullptr), childCount(0),
+      childActions(nullptr), childVisits(nullptr), childDeltas(nullptr),
+      childPending(nullptr), childProofs(nullptr),
+      provenLosses(source->provenLosses.load()),
+      slot(source->slot), proof(source->getProof()),
+      #ifdef SYMMETRY_HASH
+      frame(source->frame),
+      #endif
+      actionCount(source->actionCount),
+      moveCount(source->moveCount), untried(source->untried) {
+    Arena& arena = Arena::local();
+    actions = arena.allocateArray<index_t>(actionCount);
+    std::copy(source->actions, source->actions + actionCount, actions);
+
+    if (source->moves == source->actions) {
+        moves = actions;
+    } else {
+        moves = arena.allocateArray<index_t>(moveCount);
+        std::copy(source->moves, source->moves + moveCount, moves);
+    }
 
-    // Shuffle actions for faster rollout
-    untriedActions = data->state.possible();
-    shuffle(begin(untriedActions), end(untriedActions), Randomizer::getRng());
+    if (source->children)
+        allocateChildren();
 }
 
-Node::Node(State state, Node* parent)
-    : Node(new Statistics(state), parent) {  }
-
-Node::Node(State state)
-    : Node(state, nullptr) {  }
+template <uint8_t Size>
+void Node<Size>::allocateChildren() {
+    Arena& arena = Arena::local();
+    children = arena.allocateArray<Node*>(moveCount);
+    childActions = arena.allocateArray<index_t>(moveCount);
+    childVisits = arena.allocateArray<atomic<uint32_t>>(moveCount);
+    childDeltas = arena.allocateArray<atomic<int32_t>>(moveCount);
+    childPending = arena.allocateArray<atomic<uint32_t>>(moveCount);
+    childProofs = arena.allocateArray<atomic<int8_t>>(moveCount);
+}
 
-Node::Node()
-    : Node(State()) {  }
+template <uint8_t Size>
+void* Node<Size>::operator new(size_t size) {
+    return Arena::local().allocate(size, alignof(Node));
+}
 
-Node::~Node() { }
+template <uint8_t Size>
+Node<Size>* Node<Size>::expand(bool* transposed) {
+        // Progressive widening, children are added as visits come in
+        // Lost children make room, so forced lines can be solved
+        Engine<Size>& engine = Engine<Size>::local();
+        const float allowed = engine.widening ?
+            1 + engine.widening * std::sqrt(static_cast<float>(getVisits())) +
+            provenLosses.load(std::memory_order_relaxed) : INFINITY;
 
-Node* Node::expand() {
         // Decide which action to take
-        const index_t index = untriedActions.back();
-        untriedActions.pop_back();
+        index_t index;
+        {
+            lock_guard<Spinlock> guard(lock);
+            if (untried == 0 || moveCount - untried >= allowed)
+                return nullptr;
+            index = moves[--untried];
+
+            // Allocate once so concurrent readers never see a reallocation
+            if (!children)
+                allocateChildren();
+        }
 
         // Create matching state
-        State resultingState(data->state);
+        State<Size> resultingState(data->state);
         resultingState.action(index);
 
         // Check if state is in TT
-        Node* child;
-        Statistics* childStats;
-        auto transposeStats = Node::TT.find(resultingState.getHash());
-
-        // If state is in TT, use its statistics
-        if (transposeStats != TT.end()) {
-            Node::transposeHits++;
-            childStats = transposeStats->second;
-            child = new Node(childStats, this);
-            children.push_back(child);
-            return this->policy();
+        // If state is not in TT, create new statistics
+        Statistics<Size>* childStats = engine.TT.findOrInsert(
+            resultingState.getKey(),
+            [&resultingState]() {
+                return new Statistics<Size>(resultingState);
+            },
+            transposed);
+
+        // Every probed slot is being written, keep the statistics private
+        if (!childStats) {
+            *transposed = false;
+            childStats = new Statistics<Size>(resultingState);
         }
 
-        // If state is not in TT, create new statistics
-        Node::transposeMisses++;
+        if (*transposed)
+            engine.transposeHits++;
+        else
+            engine.transposeMisses++;
+
+        Node* child = new Node(childStats, this);
+
+        #ifdef SYMMETRY_HASH
+        // Shared statistics may hold a mirrored board, the child works
+        // in its orientation: ours, then into the canonical one and back
+        child->frame = frame;
+        if (childStats->state.getHash() != resultingState.getHash()) {
+            uint8_t ours, theirs;
+            resultingState.canonicalHash(&ours);
+            childStats->state.canonicalHash(&theirs);
+            child->frame = Utils<Size>::compose(frame,
+                Utils<Size>::compose(ours, Utils<Size>::inverse(theirs)));
+        }
+
+        // Edges keep the move of the game
+        const index_t action = Utils<Size>::transform(index,
+            Utils<Size>::inverse(frame));
+        #else
+        const index_t action = index;
+        #endif
+
+        // Publish child, its edge starts from what is known about its state
+        {
+            lock_guard<Spinlock> guard(lock);
+            const index_t count = childCount.load(std::memory_order_relaxed);
+            const bool turn = data->state.getEmpty() % 2;
+            child->slot = count;
+            childActions[count] = action;
+            new (&childVisits[count]) atomic<uint32_t>(child->getVisits());
+            new (&childDeltas[count]) atomic<int32_t>(child->qDelta(turn));
+            new (&childPending[count]) atomic<uint32_t>(0);
+            new (&childProofs[count]) atomic<int8_t>(child->getProof());
+            children[count] = child;
+            childCount.store(count + 1, std::memory_order_release);
+        }
+
+        // Five in a row, the parent is lost for whoever moved into it
+        if (resultingState.terminal() && resultingState.getResult() != 2) {
+            child->prove(PROVEN_WIN);
+            return child;
+        }
 
-        childStats = new Statistics(resultingState);
-        child = new Node(childStats, this);
-        TT.insert({ resultingState.getHash(), childStats });
-        children.push_back(child);
+        #ifndef SMALL_STATE
+        // Continuous fours of the player to move win
+        index_t move;
+        if (engine.prover.win(&resultingState, engine.vcfBudget, &move))
+            child->prove(PROVEN_LOSS);
+        #endif
 
         return child;
 }
 
-void Node::rollout() {
+template <uint8_t Size>
+void Node<Size>::rollout() {
+    uint32_t results[3] = { 0, 0, 0 };
+
+    // Solved, every playout would end the same
+    const int8_t value = getProof();
+    if (value != UNPROVEN) {
+        results[(getEmpty() + (value == PROVEN_LOSS)) % 2] = ROLLOUT_LANES;
+        backpropagate(results);
+        return;
+    }
+
+    #if !defined(SMALL_STATE) && ROLLOUT_LANES > 1
+    // Play out wins and forced blocks before going random
+    if (Engine<Size>::local().threatRollouts) {
+        Rollout<Size>::template simulateThreats<ROLLOUT_LANES>(&data->state,
+            actions, actionCount, results);
+        backpropagate(results);
+        return;
+    }
+    #endif
+
+    randomRollout(results);
+    backpropagate(results);
+}
+
+#if ROLLOUT_LANES > 1
+template <uint8_t Size>
+void Node<Size>::randomRollout(uint32_t results[3]) {
+    // Simulate all lanes at once
+    Rollout<Size>::template simulate<ROLLOUT_LANES>(&data->state, actions,
+        actionCount, results);
+}
+#else
+template <uint8_t Size>
+void Node<Size>::randomRollout(uint32_t results[3]) {
     // Max amount of actions
-    const int16_t maxActions = untriedActions.size();
+    const int16_t maxActions = actionCount;
 
-    State simulationState = State(data->state);
+    State<Size> simulationState = State<Size>(data->state);
 
     index_t index = Randomizer::randomInt<index_t>(maxActions);
 
@@ -86,133 +258,198 @@ void Node::rollout() {
             index = 0;
         }
 
-        simulationState.action(untriedActions[index]);
+        simulationState.action(actions[index]);
         index++;
     }
 
-    // Backpropagate result
-    backpropagate(simulationState.getResult());
+    results[simulationState.getResult()]++;
 }
+#endif
+
+template <uint8_t Size>
+void Node<Size>::backpropagate(const uint32_t results[3]) {
+    const uint32_t visits = results[0] + results[1] + results[2];
 
-void Node::backpropagate(const uint8_t value) {
     #ifdef RAVE
     // Rave stuff
-    Node::incrementRaveActionVisits(getParentAction());
-    Node::incrementRaveActionResults(getParentAction(), value);
+    Engine<Size>& engine = Engine<Size>::local();
+    const index_t action = getParentAction();
+    engine.raveVisits[action] += visits;
+    for (uint8_t i = 0; i < 3; i++)
+        if (results[i])
+            engine.raveResults[action][i] += results[i];
     #endif
 
     // Update statistics
-    data->visits++;
-    data->results[value]++;
-    // If parent exists, backpropagate
-    if (parent)
-        parent->backpropagate(value);
+    data->visits += visits;
+    for (uint8_t i = 0; i < 3; i++)
+        if (results[i])
+            data->results[i] += results[i];
+
+    // If parent exists, update the edge and backpropagate
+    if (parent) {
+        const int32_t delta = parent->getEmpty() % 2 ?
+            static_cast<int32_t>(results[0] - results[1]) :
+            static_cast<int32_t>(results[1] - results[0]);
+        parent->childVisits[slot] += visits;
+        parent->childDeltas[slot] += delta;
+        parent->childPending[slot]--;
+        parent->backpropagate(results);
+    }
 }
 
-int32_t Node::qDelta(const bool turn) {
+template <uint8_t Size>
+int32_t Node<Size>::qDelta(const bool turn) {
     if (turn)   return data->results[0] - data->results[1];
     else        return data->results[1] - data->results[0];
 }
 
-#ifdef RAVE
-Node* Node::bestChild() {
-    Node* bestChild = nullptr;
+template <uint8_t Size>
+void Node<Size>::addVirtualLoss() {
+    if (parent)
+        parent->childPending[slot]++;
+}
+
+template <uint8_t Size>
+void Node<Size>::prefetch() {
+    __builtin_prefetch(data);
+    __builtin_prefetch(childVisits);
+    __builtin_prefetch(childDeltas);
+    __builtin_prefetch(childPending);
+    __builtin_prefetch(childProofs);
+}
+
+template <uint8_t Size>
+void Node<Size>::prove(int8_t value) {
+    proof.store(value);
+    if (!parent)
+        return;
+    if (parent->childProofs[slot].exchange(value) != value &&
+        value == PROVEN_LOSS)
+        parent->provenLosses++;
+
+    // The opponent has a winning reply
+    if (value == PROVEN_WIN) {
+        parent->prove(PROVEN_LOSS);
+        return;
+    }
 
-    // Best result of combined UCT and RAVE
-    double bestResult = -100.0;
+    // Every move loses, only once nothing is left to expand
+    {
+        lock_guard<Spinlock> guard(parent->lock);
+        if (parent->untried)
+            return;
+    }
+    const index_t count = parent->childCount.load(std::memory_order_acquire);
+    if (count < parent->moveCount)
+        return;
+    for (index_t i = 0; i < count; i++)
+        if (parent->childProofs[i].load() != PROVEN_LOSS)
+            return;
+    parent->prove(PROVEN_WIN);
+}
 
-    // Precompute
-    const double logVisits = 2 * Node::logTable[data->visits];
+template <uint8_t Size>
+Node<Size>* Node<Size>::bestChild() {
+    const index_t count = childCount.load(std::memory_order_acquire);
 
-    // Needed for remaining code
+    // Precompute
+    const Engine<Size>& engine = Engine<Size>::local();
+    const float logVisits = 2 * fastLog(std::max(data->visits.load(), 1u));
+    const float bias = engine.explorationBias;
     const bool turn = data->state.getEmpty() % 2;
-    double evaluation, result, raveEvaluation, beta;
-    uint32_t raveVisits;
-    int32_t raveDelta;
-
-    // Iterate over all children
-    for (Node* child : children) {
-        // Node value (UCT)
-        evaluation = child->getEvaluation(turn) /
-            static_cast<double>(child->getVisits());
-
-        // RAVE value
-        raveVisits = Node::getRaveActionVisits(child->getParentAction());
-        raveDelta = Node::getRaveDelta(child->getParentAction(), turn);
-
-        if (raveVisits > 0) {
-            raveEvaluation = static_cast<double>(raveDelta) /
-                             static_cast<double>(raveVisits);
-        } else {
-            // Handle case where raveVisits is zero
-            raveEvaluation = 0.0;
-        }
-
-        // Beta parameter for balancing UCT and RAVE
-        beta = static_cast<double>(raveVisits) /
-               (raveVisits + child->getVisits() +
-                4 * raveVisits * child->getVisits() * K_PARAM);
+    #ifdef RAVE
+    const float k = engine.raveK;
+    #endif
 
-        // Combined UCT and RAVE result
-        result = (1 - beta) * evaluation + beta * raveEvaluation +
-                 EXPLORATION_BIAS *
-                 sqrt(logVisits / static_cast<double>(child->getVisits()));
+    // Snapshot of the packed edges
+    // Pending simulations count as losses
+    alignas(64) float visits[Size * Size];
+    alignas(64) float deltas[Size * Size];
+    alignas(64) float proofs[Size * Size];
+    #ifdef RAVE
+    alignas(64) float raveVisits[Size * Size];
+    alignas(64) float raveDeltas[Size * Size];
+    #endif
 
-        // Update best child
-        if (result > bestResult) {
-            bestResult = result;
-            bestChild = child;
-        }
+    for (index_t i = 0; i < count; i++) {
+        const uint32_t pending =
+            childPending[i].load(std::memory_order_relaxed) * VIRTUAL_LOSS;
+        visits[i] = childVisits[i].load(std::memory_order_relaxed) + pending;
+        deltas[i] = childDeltas[i].load(std::memory_order_relaxed) -
+            static_cast<int32_t>(pending);
+        proofs[i] = childProofs[i].load(std::memory_order_relaxed);
+
+        #ifdef RAVE
+        const index_t action = childActions[i];
+        const uint32_t p0 = engine.raveResults[action][0];
+        const uint32_t p1 = engine.raveResults[action][1];
+        raveVisits[i] = engine.raveVisits[action];
+        raveDeltas[i] = static_cast<int32_t>(turn ? p0 - p1 : p1 - p0);
+        #endif
     }
 
-    return bestChild;
-}
-#else
-Node* Node::bestChild() {
-    Node* bestChild = nullptr;
-
-    // Best result of UCT
-    double bestResult = -100.0;
+    // Branch free selection value of every child in one SIMD pass
+    alignas(64) float results[Size * Size];
+    for (index_t i = 0; i < count; i++) {
+        const float n = std::max(visits[i], 1.0f);
 
-    // Precompute
-    const double logVisits = 2 * Node::logTable[data->visits];
+        // Node value (UCT)
+        float result = deltas[i] / n;
 
-    // Needed for remaining code
-    const bool turn = data->state.getEmpty() % 2;
-    double evaluation, result;
+        #ifdef RAVE
+        // Beta parameter for balancing UCT and RAVE, 0 without RAVE visits
+        const float beta = raveVisits[i] /
+            (raveVisits[i] + n + 4 * raveVisits[i] * n * k);
 
-    // Iterate over all children
-    for (Node* child : children) {
-        // Node value
-        evaluation = child->getEvaluation(turn) /
-            static_cast<double>(getVisits());
+        // Combined UCT and RAVE result
+        result = (1 - beta) * result +
+            beta * raveDeltas[i] / std::max(raveVisits[i], 1.0f);
+        #endif
 
         // Account for exploration bias
-        result = evaluation +
-            EXPLORATION_BIAS *
-            sqrt(logVisits / static_cast<double>(getVisits()));
+        result += bias * std::sqrt(logVisits / n);
 
-        // Update best child
-        if (result > bestResult) {
-            bestResult = result;
-            bestChild = child;
+        // Not rolled out yet by the thread which created it
+        result = visits[i] > 0 ? result : -INFINITY;
+
+        // Proven children leave no doubt, but losses stay selectable
+        results[i] = proofs[i] != UNPROVEN ? proofs[i] * 50.0f : result;
+    }
+
+    // Update best child
+    Node* bestChild = nullptr;
+    float bestResult = -100.0f;
+    for (index_t i = 0; i < count; i++) {
+        if (results[i] > bestResult) {
+            bestResult = results[i];
+            bestChild = children[i];
         }
     }
 
     return bestChild;
 }
-#endif
 
 
-Node* Node::absBestChild() {
+template <uint8_t Size>
+Node<Size>* Node<Size>::absBestChild() {
+    // Play wins no matter how they were searched
+    Node* winner = winningChild();
+    if (winner)
+        return winner;
+
     // Needed for remaining code
     Node* bestChild = nullptr;
-    int32_t result;
-    int32_t bestResult = -100.0;
+    int64_t result;
+    int64_t bestResult = INT64_MIN;
 
-    // Find child with most visits
-    for (Node* child : children) {
+    // Find child with most visits, proven losses come last
+    const index_t count = childCount.load(std::memory_order_acquire);
+    for (index_t i = 0; i < count; i++) {
+        Node* child = children[i];
         result = child->getVisits();
+        if (childProofs[i].load() == PROVEN_LOSS)
+            result -= UINT32_MAX;
 
         if (result > bestResult) {
             bestResult = result;
@@ -223,112 +460,227 @@ Node* Node::absBestChild() {
     return bestChild;
 }
 
-Node* Node::policy() {
-    Node* current = this;
-    while (!current->data->state.terminal())
-        if (current->untriedActions.size() > 0)
-            return current->expand();
-        else
-            current = current->bestChild();
-    return current;
+template <uint8_t Size>
+Node<Size>* Node<Size>::winningChild() {
+    const index_t count = childCount.load(std::memory_order_acquire);
+    for (index_t i = 0; i < count; i++)
+        if (childProofs[i].load() == PROVEN_WIN)
+            return children[i];
+    return nullptr;
 }
 
+template <uint8_t Size>
+Node<Size>* Node<Size>::policy() {
+    Node* current = this;
+    Node* child;
+    bool transposed;
 
-void Node::initLogTable() {
-    for (int i = 0; i < MAX_SIMULATIONS; i++)
-        Node::logTable[i] = log(i);
-}
+    current->addVirtualLoss();
+    while (!current->data->state.terminal() &&
+        current->getProof() == UNPROVEN) {
+        child = current->expand(&transposed);
 
-double Node::getTableHitrate() {
-    return Node::transposeHits * 100 /
-        static_cast<double>(Node::transposeHits + Node::transposeMisses);
-}
+        // Fresh child, simulate from here
+        if (child && !transposed) {
+            child->addVirtualLoss();
+            return child;
+        }
 
+        // Child shares known statistics, select again
+        if (child)
+            continue;
 
-void Node::resetTTHits() {
-    Node::transposeHits = 0;
-    Node::transposeMisses = 0;
-}
+        // Fully expanded, descend
+        child = current->bestChild();
 
-void Node::resetTranspositionTable() {
-    Node::TT.clear();
-    Node::resetTTHits();
+        // Every child is still pending in other threads
+        if (!child)
+            break;
+
+        current = child;
+        current->prefetch();
+        current->addVirtualLoss();
+    }
+    return current;
 }
 
-void Node::deleteTree(Node* root) {
-    stack<Node*> nodes;
-    nodes.push(root);
 
-    // Keep track of deleted statistics
-    set<Statistics*> deletedData;
+template <uint8_t Size>
+double Node<Size>::getTableHitrate() {
+    const Engine<Size>& engine = Engine<Size>::local();
+    return engine.transposeHits * 100 /
+        static_cast<double>(engine.transposeHits + engine.transposeMisses);
+}
 
-    while (!nodes.empty()) {
-        Node* current = nodes.top();
-        nodes.pop();
+template <uint8_t Size>
+uint64_t Node<Size>::getTableReplacements() {
+    return Engine<Size>::local().TT.getReplacements();
+}
 
-        for (Node* child : current->children) {
-            nodes.push(child);
-        }
+template <uint8_t Size>
+double Node<Size>::getTableOccupancy() {
+    return Engine<Size>::local().TT.getOccupancy();
+}
 
-        // Delete data if not already deleted
-        if (deletedData.find(current->data) == deletedData.end()) {
-            delete current->data;
-            deletedData.insert(current->data);
-        }
+template <uint8_t Size>
+void Node<Size>::resetTTHits() {
+    Engine<Size>& engine = Engine<Size>::local();
+    engine.transposeHits = 0;
+    engine.transposeMisses = 0;
+}
 
-        delete current;
-    }
+template <uint8_t Size>
+void Node<Size>::resetTranspositionTable() {
+    Engine<Size>::local().TT.clear();
+    Node::resetTTHits();
 }
 
-Node* Node::getChild(index_t action) {
-    for (Node* child : children)
-        if (child->getParentAction() == action)
-            return child;
+template <uint8_t Size>
+Node<Size>* Node<Size>::getChild(index_t action) {
+    const index_t count = childCount.load(std::memory_order_acquire);
+    for (index_t i = 0; i < count; i++)
+        if (children[i]->getParentAction() == action)
+            return children[i];
     return nullptr;
 }
 
-int32_t Node::getEvaluation(const bool turn) {
+template <uint8_t Size>
+int32_t Node<Size>::getEvaluation(const bool turn) {
     int32_t eval = qDelta(turn);
     return eval;
 }
 
-State* Node::getState() {
+template <uint8_t Size>
+State<Size>* Node<Size>::getState() {
     return &data->state;
 }
 
-Node* Node::getParent() {
+template <uint8_t Size>
+Node<Size>* Node<Size>::getParent() {
     return parent;
 }
 
-index_t Node::getParentAction() {
-    return data->state.getLast();
+template <uint8_t Size>
+Index<Size> Node<Size>::getParentAction() {
+    // Transposed statistics remember the last move of another path
+    return parent ? parent->childActions[slot] : data->state.getLast();
 }
 
-vector<Node*>& Node::getChildren() {
+template <uint8_t Size>
+Node<Size>** Node<Size>::getChildren() {
     return children;
 }
 
-vector<index_t>& Node::getUntriedActions() {
-    return untriedActions;
+template <uint8_t Size>
+Index<Size> Node<Size>::getChildCount() {
+    return childCount.load(std::memory_order_acquire);
+}
+
+template <uint8_t Size>
+Index<Size>* Node<Size>::getActions() {
+    return actions;
+}
+
+template <uint8_t Size>
+Index<Size> Node<Size>::getActionCount() {
+    return actionCount;
 }
 
-uint32_t Node::getVisits() {
+template <uint8_t Size>
+Index<Size>* Node<Size>::getMoves() {
+    return moves;
+}
+
+template <uint8_t Size>
+Index<Size> Node<Size>::getMoveCount() {
+    return moveCount;
+}
+
+template <uint8_t Size>
+Index<Size> Node<Size>::getUntried() {
+    lock_guard<Spinlock> guard(lock);
+    return untried;
+}
+
+template <uint8_t Size>
+uint32_t Node<Size>::getVisits() {
     return data->visits;
 }
 
-void Node::reserveTT(uint32_t size) {
-    Node::TT.reserve(size);
+template <uint8_t Size>
+int8_t Node<Size>::getProof() {
+    return proof.load(std::memory_order_relaxed);
+}
+
+template <uint8_t Size>
+void Node<Size>::reserveTT(uint64_t bytes) {
+    Engine<Size>::local().TT.reserve(bytes);
 }
 
-uint32_t Node::getScore(uint8_t index) {
+template <uint8_t Size>
+uint32_t Node<Size>::getScore(uint8_t index) {
     return data->results[index];
 }
 
-index_t Node::getEmpty() {
+template <uint8_t Size>
+Index<Size> Node<Size>::getEmpty() {
     return data->state.getEmpty();
 }
 
-void Node::reset() {
+template <uint8_t Size>
+Statistics<Size>* Node<Size>::copyStatistics(Node* source) {
+    bool found;
+    Statistics<Size>* copy = Engine<Size>::local().TT.findOrInsert(
+        source->data->state.getKey(),
+        [source]() { return new Statistics<Size>(source->data); },
+        &found);
+
+    // The copied node keeps its orientation
+    if (!copy || copy->state.getHash() != source->data->state.getHash())
+        copy = new Statistics<Size>(source->data);
+    return copy;
+}
+
+template <uint8_t Size>
+Node<Size>* Node<Size>::promote(Node* subtree) {
+    // Old tree stays readable in the standby pool while copying
+    Arena::swapPools();
+    Node::reset();
+
+    Node* root = new Node(subtree, copyStatistics(subtree), nullptr);
+
+    // Pairs of already copied node and its source
+    vector<std::pair<Node*, Node*>> pending;
+    pending.push_back({ root, subtree });
+
+    while (!pending.empty()) {
+        auto [copy, source] = pending.back();
+        pending.pop_back();
+
+        const index_t count = source->getChildCount();
+        for (index_t i = 0; i < count; i++) {
+            Node* child = source->children[i];
+            copy->children[i] = new Node(child, copyStatistics(child), copy);
+            copy->childActions[i] = source->childActions[i];
+            new (&copy->childVisits[i])
+                atomic<uint32_t>(source->childVisits[i].load());
+            new (&copy->childDeltas[i])
+                atomic<int32_t>(source->childDeltas[i].load());
+            new (&copy->childPending[i]) atomic<uint32_t>(0);
+            new (&copy->childProofs[i])
+                atomic<int8_t>(source->childProofs[i].load());
+            pending.push_back({ copy->children[i], child });
+        }
+        copy->childCount.store(count, std::memory_order_release);
+    }
+
+    // Release siblings and ancestors
+    Arena::resetStandby();
+    return root;
+}
+
+template <uint8_t Size>
+void Node<Size>::reset() {
     Node::resetTranspositionTable();
     #ifdef RAVE
     Node::resetRave();
@@ -336,45 +688,63 @@ void Node::reset() {
 }
 
 #ifdef RAVE
-void Node::resetRave() {
-    memset(Node::raveResults, 0, sizeof(Node::raveResults));
-    memset(Node::raveVisits, 0, sizeof(Node::raveVisits));
+template <uint8_t Size>
+void Node<Size>::resetRave() {
+    Engine<Size>& engine = Engine<Size>::local();
+    for (index_t i = 0; i < Size * Size; i++) {
+        engine.raveVisits[i] = 0;
+        for (uint8_t j = 0; j < 3; j++)
+            engine.raveResults[i][j] = 0;
+    }
 }
 
-uint32_t Node::getRaveActionResults(index_t action, uint8_t index) {
-    return Node::raveResults[action][index];
+template <uint8_t Size>
+uint32_t Node<Size>::getRaveActionResults(index_t action, uint8_t index) {
+    return Engine<Size>::local().raveResults[action][index];
 }
 
-uint32_t Node::getRaveActionVisits(index_t action) {
-    return Node::raveVisits[action];
+template <uint8_t Size>
+uint32_t Node<Size>::getRaveActionVisits(index_t action) {
+    return Engine<Size>::local().raveVisits[action];
 }
 
-void Node::incrementRaveActionVisits(index_t action) {
-    Node::raveVisits[action]++;
+template <uint8_t Size>
+void Node<Size>::incrementRaveActionVisits(index_t action, uint32_t count) {
+    Engine<Size>::local().raveVisits[action] += count;
 }
 
-void Node::incrementRaveActionResults(index_t action, uint8_t index) {
-    Node::raveResults[action][index]++;
+template <uint8_t Size>
+void Node<Size>::incrementRaveActionResults(index_t action, uint8_t index,
+    uint32_t count) {
+    Engine<Size>::local().raveResults[action][index] += count;
 }
 
-int32_t Node::getRaveDelta(uint32_t action, bool turn) {
+template <uint8_t Size>
+int32_t Node<Size>::getRaveDelta(uint32_t action, bool turn) {
+    const Engine<Size>& engine = Engine<Size>::local();
     if (turn)
-        return Node::raveResults[action][0] - Node::raveResults[action][1];
+        return engine.raveResults[action][0] - engine.raveResults[action][1];
     else
-        return Node::raveResults[action][1] - Node::raveResults[action][0];
+        return engine.raveResults[action][1] - engine.raveResults[action][0];
 }
 
-void Node::printRaveTable(bool turn) {
+template <uint8_t Size>
+void Node<Size>::printRaveTable(bool turn) {
     cout << "Rave Table:\n";
     uint8_t x, y;
-    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; i++) {
-        Utils::indexToCords(i, &x, &y);
+    for (int i = 0; i < Size * Size; i++) {
+        Utils<Size>::indexToCords(i, &x, &y);
         cout    << "Action:  [" << static_cast<int>(x) << ","
                 << static_cast<int>(y) << "] "
-                << " Visits: " << Node::raveVisits[i]
+                << " Visits: " << Node::getRaveActionVisits(i)
                 << " Delta: " << Node::getRaveDelta(i, turn) << "\n"
                 << " Relative: " << Node::getRaveDelta(i, turn) /
-                static_cast<double>(Node::raveVisits[i]) << "\n";
+                static_cast<double>(Node::getRaveActionVisits(i)) << "\n";
     }
 }
 #endif
+
+// Explicit template instantiation for compiled board sizes
+#define INSTANTIATE(SIZE) template class Node<SIZE>;
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
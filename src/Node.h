@@ -8,34 +8,49 @@
 #include <stdint.h>
 #include <vector>
 #include <iostream>
-#include <unordered_map>
 #include <algorithm>
-#include <stack>
-#include <set>
+#include <cmath>
+#include <atomic>
+#include <mutex>
+#include <new>
 
 #include "Config.h"
 #include "State.h"
 #include "Statistics.h"
 #include "Randomizer.h"
+#include "Spinlock.h"
+#include "Arena.h"
+#include "TranspositionTable.h"
+#include "Engine.h"
+#include "Rollout.h"
 
-using std::unordered_map;
 using std::vector;
-using std::uniform_int_distribution;
-using std::random_device;
-using std::mt19937;
 using std::begin;
 using std::end;
-using std::shuffle;
 using std::sqrt;
 using std::log;
-using std::stack;
 using std::endl;
 using std::cout;
-using std::set;
+using std::atomic;
+using std::lock_guard;
 
 
+/**
+ * Search tree node on a board of Size
+*/
+template <uint8_t Size>
 class Node {
  public:
+    typedef Index<Size> index_t;
+
+    /**
+     * Proven outcomes, from the perspective of the player
+     * who moved into the node
+    */
+    static constexpr int8_t UNPROVEN = 0;
+    static constexpr int8_t PROVEN_WIN = 1;
+    static constexpr int8_t PROVEN_LOSS = -1;
+
     /**
      * Default constructor
     */
@@ -44,43 +59,60 @@ class Node {
     /**
      * Fixed state constructor
     */
-    explicit Node(State state);
+    explicit Node(State<Size> state);
 
     /**
      * Parent data constructor
     */
-    explicit Node(State state, Node* parent);
+    explicit Node(State<Size> state, Node* parent);
 
     /**
      * Inherited statistics constructor
     */
-    explicit Node(Statistics* statistics, Node* parent);
+    explicit Node(Statistics<Size>* statistics, Node* parent);
 
     /**
-     * Deconstructor
-     * Recursively delete all children
+     * Nodes live in the calling threads arena
+     * Released all at once by Arena::resetAll
     */
-    ~Node();
+    static void* operator new(size_t size);
+    static void operator delete(void*) {  }
 
     /**
      * Rollout from this node
      * Randomly choose actions until terminal state is reached
+     * Plays ROLLOUT_LANES games at once if enabled,
+     * after the forced moves if the engine asks for threat rollouts
+     * Proven nodes score their outcome without playing
      * Backpropagate the result
     */
     void rollout();
 
     /**
      * Get the best child node for the UCT algorithm
+     * Proven wins are always taken, proven losses only if nothing
+     * else is left
     */
     Node* bestChild();
 
     /**
      * This version gets the final best child
+     * A proven win beats any visit count, proven losses are
+     * only played if every child loses
     */
     Node* absBestChild();
 
+    /**
+     * Expanded child proven to win, nullptr if none
+    */
+    Node* winningChild();
+
     /**
     * MCTS policy algorithm
+    * Stops at terminal and proven nodes
+    * Applies virtual loss to every node on the selected path,
+    * which is removed again by the backpropagation
+    * Safe to call from multiple threads on the same tree
     */
     Node* policy();
 
@@ -96,11 +128,6 @@ class Node {
     */
     int32_t getEvaluation(const bool turn);
 
-    /**
-    * Initialize the log table
-    */
-    static void initLogTable();
-
     /**
      * Delete the transposition table
     */
@@ -112,19 +139,24 @@ class Node {
     static double getTableHitrate();
 
     /**
-     * Reset TT hits to 0
+     * Get TT entries replaced in this search
     */
-    static void resetTTHits();
+    static uint64_t getTableReplacements();
 
     /**
-     * Iteratively delete tree
+     * Get percentage of TT slots in use
     */
-    static void deleteTree(Node* root);
+    static double getTableOccupancy();
+
+    /**
+     * Reset TT hits to 0
+    */
+    static void resetTTHits();
 
     /**
      * Get the state
     */
-    State* getState();
+    State<Size>* getState();
 
     /**
      * Get Parent
@@ -133,18 +165,47 @@ class Node {
 
     /**
      * Get Parent Action
+     * The move of the game leading here, not the last move of a
+     * transposed state
     */
     index_t getParentAction();
 
     /**
      * Get children
     */
-    vector<Node*>& getChildren();
+    Node** getChildren();
+
+    /**
+     * Get number of expanded children
+    */
+    index_t getChildCount();
+
+    /**
+     * Get shuffled actions, every empty field
+    */
+    index_t* getActions();
 
     /**
-     * Get untried actions
+     * Get number of actions
     */
-    vector<index_t>& getUntriedActions();
+    index_t getActionCount();
+
+    /**
+     * Get the moves the tree may expand, shuffled or with widening
+     * ordered by ascending prior
+     * The first getUntried() entries have not been expanded yet
+    */
+    index_t* getMoves();
+
+    /**
+     * Get number of moves
+    */
+    index_t getMoveCount();
+
+    /**
+     * Get number of untried actions
+    */
+    index_t getUntried();
 
     /**
      * Get the number of visits
@@ -152,9 +213,14 @@ class Node {
     uint32_t getVisits();
 
     /**
-     * Reserve Transposition Table
+     * Get the proven outcome, UNPROVEN if unknown
     */
-    static void reserveTT(uint32_t size);
+    int8_t getProof();
+
+    /**
+     * Reserve Transposition Table within a budget of bytes
+    */
+    static void reserveTT(uint64_t bytes);
 
     /**
      * Get empty field count
@@ -172,18 +238,27 @@ class Node {
     Node* getChild(index_t action);
 
     /**
-     * Resets the node statics for a new search
+     * Resets the statics of the bound engine for a new search
     */
     static void reset();
 
+    /**
+     * Make subtree the root of the search tree
+     * Copies subtree into the standby arenas, rebuilds the TT from it
+     * and releases the rest of the old tree
+     * Not thread safe, no search may be running
+    */
+    static Node* promote(Node* subtree);
+
     #ifdef RAVE
     /**
      * Get from RAVE table
     */
     static uint32_t getRaveActionVisits(index_t action);
-    static void incrementRaveActionVisits(index_t action);
+    static void incrementRaveActionVisits(index_t action, uint32_t count);
     static uint32_t getRaveActionResults(index_t action, uint8_t index);
-    static void incrementRaveActionResults(index_t action, uint8_t index);
+    static void incrementRaveActionResults(index_t action, uint8_t index,
+        uint32_t count);
     static int32_t getRaveDelta(uint32_t action, bool turn);
     static void printRaveTable(bool turn);
     /**
@@ -195,40 +270,123 @@ class Node {
  private:
     /**
      * Expand the node by adding a new child node.
+     * Returns nullptr if there is nothing left to expand
+     * or progressive widening allows no further child yet
+     * Sets transposed if the child reuses statistics from the TT
+    */
+    Node* expand(bool* transposed);
+
+    /**
+     * Random playouts of rollout, adds their outcomes to results
+    */
+    void randomRollout(uint32_t results[3]);
+
+    /**
+     * Mark the node as proven and update the ancestors
+     * A proven win loses the parent, a proven loss wins it
+     * once every move of the parent is expanded and lost
+     * Losses only consider the moves the tree expands
+    */
+    void prove(int8_t value);
+
+    /**
+     * Mark a pending simulation on this node
+     * Stored in the parents packed child statistics
+    */
+    void addVirtualLoss();
+
+    /**
+     * Allocate children and their packed statistics for every action
+    */
+    void allocateChildren();
+
+    /**
+     * Pull in what selection reads next from this node
+    */
+    void prefetch();
+
+    /**
+     * Copy constructor used by promote
+     * Children are linked afterwards
     */
-    Node* expand();
+    explicit Node(Node* source, Statistics<Size>* statistics, Node* parent);
 
     /**
-     * Backpropagate the result of a rollout
+     * Copy statistics of a node into the current TT
+     * Entries of a mirrored board are not shared
     */
-    void backpropagate(uint8_t value);
+    static Statistics<Size>* copyStatistics(Node* source);
+
+    /**
+     * Backpropagate the results of a rollout
+     * 0: p0win 1: p1win 2: draws
+    */
+    void backpropagate(const uint32_t results[3]);
 
     Node* parent;
-    Statistics* data;
-    vector<Node*> children;
-    vector<index_t> untriedActions;
+    Statistics<Size>* data;
 
     /**
-     * Transposition table
+     * Children are allocated on first expansion and never reallocated,
+     * readers only look at the first childCount entries
     */
-    static unordered_map<uint64_t, Statistics*> TT;
+    Node** children;
+    atomic<index_t> childCount;
 
     /**
-     * TT hits
+     * Packed statistics of the edges to the children, indexed like children
+     * so bestChild scans contiguous arrays instead of chasing pointers
+     * Deltas are results of the player moving into the child minus
+     * results of the opponent, pending simulations are counted apart
     */
-    static uint32_t transposeHits;
-    static uint32_t transposeMisses;
+    index_t* childActions;
+    atomic<uint32_t>* childVisits;
+    atomic<int32_t>* childDeltas;
+    atomic<uint32_t>* childPending;
+    atomic<int8_t>* childProofs;
+
+    /**
+     * Children proven lost, progressive widening does not count them
+    */
+    atomic<index_t> provenLosses;
+
+    /**
+     * Index of this node in the children of its parent
+    */
+    index_t slot;
 
-    #ifdef RAVE
     /**
-     * RAVE table
+     * Proven outcome of the node, UNPROVEN until solved
     */
-    static uint32_t raveVisits[BOARD_SIZE * BOARD_SIZE];
-    static uint32_t raveResults[BOARD_SIZE * BOARD_SIZE][3];
+    atomic<int8_t> proof;
+
+    #ifdef SYMMETRY_HASH
+    /**
+     * Symmetry from the board of the game onto the board of data
+     * Nodes on mirrored statistics work in their orientation,
+     * childActions are mapped back to the game
+    */
+    uint8_t frame;
     #endif
 
     /**
-     * Log lookup table
+     * Shuffled empty fields, never modified after construction
+     * so rollouts can read them while the node is being expanded
+    */
+    index_t* actions;
+    index_t actionCount;
+
+    /**
+     * Fields near stones which the tree expands from the back,
+     * shuffled and with progressive widening sorted by prior
+     * The same array as actions if the engine has neither
+    */
+    index_t* moves;
+    index_t moveCount;
+    index_t untried;
+
+    /**
+     * Guards untried and children against concurrent expansion
     */
-    static double logTable[MAX_SIMULATIONS];
+    Spinlock lock;
 };
@@ -0,0 +1,397 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+
+#include <chrono> //NOLINT
+
+#include "State.h"
+#include "Config.h"
+#include "Utilities.h"
+#include "Node.h"
+#include "Search.h"
+
+using std::cin;
+using std::cout;
+using std::endl;
+using std::string;
+using std::getline;
+using std::istringstream;
+using std::vector;
+using std::chrono::milliseconds;
+using std::chrono::steady_clock;
+using std::chrono::duration_cast;
+
+/**
+ * Headless engine for tournament managers
+ * Speaks the Gomocup (Piskvork) protocol over stdin / stdout
+*/
+
+/**
+ * Limits announced by the manager via INFO
+*/
+struct Limits {
+    /**
+     * Milliseconds per move, 0 plays as fast as possible
+    */
+    int64_t turn = 5000;
+
+    /**
+     * Milliseconds per game, 0 for no limit
+    */
+    int64_t match = 0;
+
+    /**
+     * Milliseconds left in the game
+    */
+    int64_t left = INT64_MAX;
+
+    /**
+     * Bytes for the whole process, 0 for no limit
+    */
+    uint64_t memory = 0;
+};
+
+/**
+ * Time kept back per move for communication and tree setup
+*/
+const int64_t MOVE_OVERHEAD = 30;
+
+/**
+ * Shortest search we ever run
+*/
+const int64_t MIN_MOVE_TIME = 5;
+
+/**
+ * Own moves the remaining match time is spread over
+ * Games rarely fill the board, so the estimate is clamped
+*/
+const int64_t MIN_MOVES_LEFT = 8;
+const int64_t MAX_MOVES_LEFT = 30;
+
+/**
+ * Memory not available to the search, code and stacks
+*/
+const uint64_t BASE_MEMORY = uint64_t(32) << 20;
+
+/**
+ * Time for the next move
+ * Spreads the match time left over the moves still expected,
+ * capped by the turn limit and minus a safety margin
+*/
+milliseconds allocateTime(const Limits& limits, uint32_t empty) {
+    int64_t budget = limits.turn;
+
+    if (limits.match > 0) {
+        const int64_t movesLeft = std::clamp<int64_t>(empty / 2,
+            MIN_MOVES_LEFT, MAX_MOVES_LEFT);
+        budget = std::min(budget, limits.left / movesLeft);
+    }
+
+    // Overhead grows with the budget, promoting big trees takes longer
+    budget -= MOVE_OVERHEAD + budget / 20;
+    return milliseconds(std::max(budget, MIN_MOVE_TIME));
+}
+
+/**
+ * Split the memory limit between the TT and the search trees
+ * Trees get a third of the rest, promoting copies a subtree into
+ * a second arena pool and arenas grow in whole blocks
+*/
+template <uint8_t Size>
+void allocateMemory(const Limits& limits) {
+    const uint64_t table = uint64_t(TABLE_MEMORY) << 20;
+
+    if (!limits.memory) {
+        Node<Size>::reserveTT(table);
+        MCTS_limitMemory(0);
+        return;
+    }
+
+    const uint64_t available = limits.memory > BASE_MEMORY ?
+        limits.memory - BASE_MEMORY : 0;
+    const uint64_t budget = std::min(table, available / 4);
+    Node<Size>::reserveTT(budget);
+    MCTS_limitMemory(std::max<uint64_t>((available - budget) / 3, 1));
+}
+
+/**
+ * Read "x,y" into cords, false if malformed or off the board
+*/
+template <uint8_t Size>
+bool parseCords(const string& text, int* x, int* y) {
+    char comma;
+    istringstream stream(text);
+    if (!(stream >> *x >> comma >> *y) || comma != ',')
+        return false;
+    return 0 <= *x && *x < Size && 0 <= *y && *y < Size;
+}
+
+/**
+ * Search the state within the limits and announce the move
+ * Time used is taken off the match clock, so time saved by
+ * settled moves goes to later ones until the manager reports
+*/
+template <uint8_t Size>
+void think(State<Size>* state, vector<Index<Size>>* history,
+    Limits* limits) {
+    const auto start = steady_clock::now();
+    MCTS_move(state, allocateTime(*limits, state->getEmpty()));
+    history->push_back(state->getLast());
+
+    if (limits->match > 0 && limits->left != INT64_MAX)
+        limits->left -= duration_cast<milliseconds>(
+            steady_clock::now() - start).count();
+
+    int x, y;
+    Utils<Size>::indexToCords(state->getLast(), &x, &y);
+    cout << x << "," << y << endl;
+}
+
+/**
+ * Replay moves in order onto a fresh state
+*/
+template <uint8_t Size>
+State<Size> replay(const vector<Index<Size>>& history) {
+    State<Size> state;
+    for (Index<Size> action : history)
+        state.action(action);
+    return state;
+}
+
+/**
+ * Apply the arguments of an INFO command
+ * Returns the key, unknown keys are ignored
+*/
+string applyInfo(const string& arguments, Limits* limits) {
+    string key;
+    int64_t value = 0;
+    istringstream(arguments) >> key >> value;
+
+    if (key == "timeout_turn")
+        limits->turn = value;
+    else if (key == "timeout_match")
+        limits->match = value;
+    else if (key == "time_left")
+        limits->left = value;
+    else if (key == "max_memory")
+        limits->memory = value;
+    return key;
+}
+
+/**
+ * Answer the ABOUT command
+*/
+void about() {
+    cout << "name=\"GomokuMCTS\", author=\"Alexander Kurtz\"" << endl;
+}
+
+/**
+ * Read the next line without its line ending, false at end of input
+*/
+bool readLine(string* text) {
+    if (!getline(cin, *text))
+        return false;
+    if (!text->empty() && text->back() == '\r')
+        text->pop_back();
+    return true;
+}
+
+/**
+ * Split a line into its upper case command and the arguments
+*/
+string command(const string& text, string* arguments) {
+    istringstream line(text);
+    string name;
+    line >> name;
+    getline(line >> std::ws, *arguments);
+    std::transform(name.begin(), name.end(), name.begin(),
+        [](unsigned char c) { return std::toupper(c); });
+    return name;
+}
+
+/**
+ * Play games on a board of Size until END
+ * Returns the size requested by a START for another board, 0 on END
+*/
+template <uint8_t Size>
+int session(Limits* limits) {
+    initBoard<Size>();
+    allocateMemory<Size>(*limits);
+    MCTS_openBook<Size>();
+
+    State<Size> state;
+    vector<Index<Size>> history;
+    cout << "OK" << endl;
+
+    string text, rest;
+    while (readLine(&text)) {
+        const string name = command(text, &rest);
+        int x, y;
+
+        if (name == "START") {
+            const int size = atoi(rest.c_str());
+            if (size <= 0) {
+                cout << "ERROR invalid size " << rest << endl;
+                continue;
+            }
+            if (size != Size)
+                return size;
+            state = State<Size>();
+            history.clear();
+            cout << "OK" << endl;
+        } else if (name == "RESTART") {
+            state = State<Size>();
+            history.clear();
+            cout << "OK" << endl;
+        } else if (name == "BEGIN") {
+            if (!history.empty())
+                cout << "ERROR board is not empty" << endl;
+            else
+                think(&state, &history, limits);
+        } else if (name == "TURN") {
+            if (!parseCords<Size>(rest, &x, &y) || !state.isEmpty(x, y)) {
+                cout << "ERROR invalid move " << rest << endl;
+                continue;
+            }
+            state.action(x, y);
+            Index<Size> index;
+            Utils<Size>::cordsToIndex(&index, x, y);
+            history.push_back(index);
+            if (state.terminal())
+                cout << "ERROR game is over" << endl;
+            else
+                think(&state, &history, limits);
+        } else if (name == "BOARD") {
+            // Own and opponents stones, in the order they were sent
+            vector<Index<Size>> stones[2];
+            bool valid = true;
+            while (readLine(&text)) {
+                if (text == "DONE")
+                    break;
+
+                const size_t split = text.find_last_of(',');
+                const int field = split == string::npos ? 0 :
+                    atoi(text.c_str() + split + 1);
+                if (split == string::npos || (field != 1 && field != 2) ||
+                    !parseCords<Size>(text.substr(0, split), &x, &y)) {
+                    valid = false;
+                    continue;
+                }
+                Index<Size> index;
+                Utils<Size>::cordsToIndex(&index, x, y);
+                stones[field - 1].push_back(index);
+            }
+
+            // Colors follow the move parity, so interleave both sides
+            // starting with whoever has more stones or the opponent
+            const vector<Index<Size>>& own = stones[0];
+            const vector<Index<Size>>& other = stones[1];
+            const bool ownFirst = own.size() == other.size();
+            const vector<Index<Size>>& first = ownFirst ? own : other;
+            const vector<Index<Size>>& second = ownFirst ? other : own;
+            valid &= first.size() == second.size() ||
+                first.size() == second.size() + 1;
+
+            history.clear();
+            for (size_t i = 0; valid && i < first.size(); i++) {
+                history.push_back(first[i]);
+                if (i < second.size())
+                    history.push_back(second[i]);
+            }
+
+            // No cell may be listed twice
+            vector<Index<Size>> cells = history;
+            std::sort(cells.begin(), cells.end());
+            valid &= std::adjacent_find(cells.begin(), cells.end()) ==
+                cells.end();
+
+            state = replay<Size>(history);
+
+            if (!valid || state.terminal()) {
+                cout << "ERROR unsupported position" << endl;
+                state = State<Size>();
+                history.clear();
+                continue;
+            }
+            think(&state, &history, limits);
+        } else if (name == "TAKEBACK") {
+            Index<Size> index;
+            if (!parseCords<Size>(rest, &x, &y) || history.empty()) {
+                cout << "ERROR invalid takeback " << rest << endl;
+                continue;
+            }
+            Utils<Size>::cordsToIndex(&index, x, y);
+            if (history.back() != index) {
+                cout << "ERROR only the last move can be taken back" << endl;
+                continue;
+            }
+            history.pop_back();
+            state = replay<Size>(history);
+            cout << "OK" << endl;
+        } else if (name == "INFO") {
+            if (applyInfo(rest, limits) == "max_memory")
+                allocateMemory<Size>(*limits);
+        } else if (name == "ABOUT") {
+            about();
+        } else if (name == "END") {
+            return 0;
+        } else if (!name.empty()) {
+            cout << "UNKNOWN " << name << endl;
+        }
+    }
+
+    return 0;
+}
+
+int main() {
+    init();
+
+    Limits limits;
+    string text, rest;
+    while (readLine(&text)) {
+        const string name = command(text, &rest);
+
+        if (name == "START") {
+            int size = atoi(rest.c_str());
+            if (size <= 0) {
+                cout << "ERROR invalid size " << rest << endl;
+                continue;
+            }
+
+            // Sessions return the size of a START for another board
+            while (size > 0) {
+                const int requested = size;
+                size = -1;
+                if (requested < 64)
+                    withBoardSize(requested, [&]<uint8_t Size>() {
+                        size = session<Size>(&limits);
+                    });
+
+                if (size == -1)
+                    cout << "ERROR unsupported size " << requested
+                        << ", compiled sizes: " << boardSizes() << endl;
+            }
+
+            // Session saw END
+            if (size == 0)
+                return 0;
+        } else if (name == "INFO") {
+            applyInfo(rest, &limits);
+        } else if (name == "ABOUT") {
+            about();
+        } else if (name == "END") {
+            return 0;
+        } else if (!name.empty()) {
+            cout << "UNKNOWN " << name << endl;
+        }
+    }
+}
@@ -4,22 +4,47 @@
 
 #include "Randomizer.h"
 
-std::random_device Randomizer::rd;
-std::mt19937_64 Randomizer::rng(rd());
+thread_local Randomizer::Generator Randomizer::rng;
 
-void Randomizer::initialize(uint64_t seed) {
-    rng.seed(seed);
+Randomizer::Generator::Generator() {
+    seed(0);
 }
 
-template <typename T>
-T Randomizer::randomInt(T max) {
-    std::uniform_int_distribution<T> dist(0, max - 1);
-    return dist(rng);
+void Randomizer::Generator::seed(uint64_t seed) {
+    // splitmix64, never yields an all zero state
+    for (uint64_t& word : state) {
+        uint64_t z = (seed += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        word = z ^ (z >> 31);
+    }
 }
 
-std::mt19937_64& Randomizer::getRng() {
-    return rng;
+void Randomizer::Generator::jump() {
+    static const uint64_t JUMP[] = {
+        0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+        0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+
+    uint64_t jumped[4] = { 0, 0, 0, 0 };
+    for (uint64_t polynomial : JUMP) {
+        for (int bit = 0; bit < 64; bit++) {
+            if (polynomial & (uint64_t(1) << bit))
+                for (int i = 0; i < 4; i++)
+                    jumped[i] ^= state[i];
+            (*this)();
+        }
+    }
+
+    for (int i = 0; i < 4; i++)
+        state[i] = jumped[i];
 }
 
-// Explicit template instantiation for common types
-template index_t Randomizer::randomInt<index_t>(index_t);
+void Randomizer::initialize(uint64_t seed, uint64_t stream) {
+    rng.seed(seed);
+    for (uint64_t i = 0; i < stream; i++)
+        rng.jump();
+}
+
+Randomizer::Generator& Randomizer::getRng() {
+    return rng;
+}
@@ -5,24 +5,95 @@
  */
 
 
-#include <random>
 #include <cstdint>
+#include <limits>
+#include <utility>
 
 #include "Config.h"
 
 class Randomizer {
+ public:
+    /**
+     * xoshiro256** generator
+     * 32 bytes of state, satisfies UniformRandomBitGenerator
+    */
+    class Generator {
+     public:
+        typedef uint64_t result_type;
+
+        Generator();
+
+        // Seed state via splitmix64
+        void seed(uint64_t seed);
+
+        // Advance by 2^128 steps, gives a non overlapping stream
+        void jump();
+
+        uint64_t operator()() {
+            const uint64_t result = rotl(state[1] * 5, 7) * 9;
+            const uint64_t t = state[1] << 17;
+
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotl(state[3], 45);
+
+            return result;
+        }
+
+        static constexpr uint64_t min() { return 0; }
+        static constexpr uint64_t max() {
+            return std::numeric_limits<uint64_t>::max();
+        }
+
+     private:
+        static uint64_t rotl(uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        uint64_t state[4];
+    };
+
  private:
-    static std::random_device rd;
-    static std::mt19937_64 rng;
+    static thread_local Generator rng;
 
  public:
-    // Initialize the random number generator with a seed
-    static void initialize(uint64_t seed);
+    // Initialize the calling threads random number generator
+    // Threads using the same seed and distinct streams never overlap
+    static void initialize(uint64_t seed, uint64_t stream = 0);
+
+    // Get a random 64 bit value
+    static uint64_t next() {
+        return rng();
+    }
 
     // Get a random integer between 0 and max-1
+    // Unbiased, multiply and shift instead of modulo (Lemire)
+    template <typename T>
+    static T randomInt(T max) {
+        const uint32_t range = max;
+        uint64_t product = (rng() >> 32) * range;
+
+        // Reject the few values which would bias the result,
+        // the modulo only runs with probability range / 2^32
+        if (static_cast<uint32_t>(product) < range) {
+            const uint32_t threshold = -range % range;
+            while (static_cast<uint32_t>(product) < threshold)
+                product = (rng() >> 32) * range;
+        }
+
+        return static_cast<T>(product >> 32);
+    }
+
+    // Fisher-Yates shuffle of [begin, end)
     template <typename T>
-    static T randomInt(T max);
+    static void shuffle(T* begin, T* end) {
+        for (uint32_t i = end - begin; i > 1; i--)
+            std::swap(begin[i - 1], begin[randomInt<uint32_t>(i)]);
+    }
 
     // Access the RNG directly
-    static std::mt19937_64& getRng();
+    static Generator& getRng();
 };
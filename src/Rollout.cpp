@@ -0,0 +1,203 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include "Rollout.h"
+
+
+template <uint8_t Size>
+const vector<typename Rollout<Size>::Window>& Rollout<Size>::windows() {
+    static const vector<Window> all = []() {
+        vector<Window> result;
+
+        // Horizontal, Vertical, LDiagonal, RDiagonal
+        const int8_t directions[4][2] = { {1, 0}, {0, 1}, {1, 1}, {1, -1} };
+
+        for (const auto& direction : directions) {
+            for (int x = 0; x < Size; x++) {
+                for (int y = 0; y < Size; y++) {
+                    const int endX = x + direction[0] * 4;
+                    const int endY = y + direction[1] * 4;
+                    if (endX < 0 || endX >= Size ||
+                        endY < 0 || endY >= Size)
+                        continue;
+
+                    Window window;
+                    for (int i = 0; i < 5; i++)
+                        Utils<Size>::cordsToIndex(&window.cells[i],
+                            x + direction[0] * i, y + direction[1] * i);
+                    result.push_back(window);
+                }
+            }
+        }
+
+        return result;
+    }();
+
+    return all;
+}
+
+template <uint8_t Size>
+template <uint8_t LANES>
+void Rollout<Size>::simulate(State<Size>* state, const index_t* actions,
+    index_t count, uint32_t results[3]) {
+    // Nothing left to play
+    if (state->terminal()) {
+        results[state->getResult()] += LANES;
+        return;
+    }
+
+    /**
+     * Time a cell gets its stone per lane
+     * Rollout move t is played at time t + 2 by color (empty - 1 - t) % 2,
+     * so only the parity of a time decides its color.
+     * Existing stones get time 0 or 1 matching their color.
+    */
+    alignas(64) uint16_t times[Size * Size][LANES];
+    int8_t colors[Size * Size];
+    const index_t empty = state->getEmpty();
+
+    for (index_t i = 0; i < Size * Size; i++) {
+        colors[i] = state->getCellValue(i);
+        if (colors[i] == -1)
+            continue;
+        const uint16_t parity = (empty - 1 - colors[i]) & 1;
+        for (uint8_t lane = 0; lane < LANES; lane++)
+            times[i][lane] = parity;
+    }
+
+    // Random start per lane
+    int16_t starts[LANES];
+    for (uint8_t lane = 0; lane < LANES; lane++)
+        starts[lane] = Randomizer::randomInt<index_t>(count);
+
+    for (index_t i = 0; i < count; i++) {
+        uint16_t* cell = times[actions[i]];
+        for (uint8_t lane = 0; lane < LANES; lane++) {
+            int16_t time = i - starts[lane];
+            time += (time < 0) * count;
+            cell[lane] = time + 2;
+        }
+    }
+
+    // Earliest single colored window per lane
+    const uint16_t never = UINT16_MAX;
+    alignas(64) uint16_t first[LANES];
+    for (uint8_t lane = 0; lane < LANES; lane++)
+        first[lane] = never;
+
+    for (const Window& window : windows()) {
+        // Skip windows already blocked by both colors
+        int8_t seen = -1;
+        bool blocked = false;
+        for (index_t cell : window.cells) {
+            const int8_t color = colors[cell];
+            if (color == -1)
+                continue;
+            blocked |= seen != -1 && seen != color;
+            seen = color;
+        }
+        if (blocked)
+            continue;
+
+        const uint16_t* c0 = times[window.cells[0]];
+        const uint16_t* c1 = times[window.cells[1]];
+        const uint16_t* c2 = times[window.cells[2]];
+        const uint16_t* c3 = times[window.cells[3]];
+        const uint16_t* c4 = times[window.cells[4]];
+
+        for (uint8_t lane = 0; lane < LANES; lane++) {
+            uint16_t latest = std::max(std::max(c0[lane], c1[lane]),
+                std::max(std::max(c2[lane], c3[lane]), c4[lane]));
+            const uint16_t all = c0[lane] & c1[lane] & c2[lane] &
+                c3[lane] & c4[lane];
+            const uint16_t any = c0[lane] | c1[lane] | c2[lane] |
+                c3[lane] | c4[lane];
+
+            // Mixed parities never complete
+            latest |= ((all ^ any) & 1) ? never : 0;
+            first[lane] = std::min(first[lane], latest);
+        }
+    }
+
+    for (uint8_t lane = 0; lane < LANES; lane++) {
+        if (first[lane] == never)
+            results[2]++;
+        else
+            results[((empty - 1) ^ first[lane]) & 1]++;
+    }
+}
+
+#ifndef SMALL_STATE
+template <uint8_t Size>
+template <uint8_t LANES>
+void Rollout<Size>::simulateThreats(State<Size>* state,
+    const index_t* actions, index_t count, uint32_t results[3]) {
+    State<Size> forced(*state);
+    index_t fives[Size * Size];
+    bool played[Size * Size] = {};
+    bool any = false;
+
+    while (!forced.terminal()) {
+        // Color placing the next stone
+        const uint8_t color = (forced.getEmpty() - 1) % 2;
+
+        // Completing five wins every playout
+        if (forced.fives(color, fives)) {
+            results[color] += LANES;
+            return;
+        }
+
+        // One stone can not block two fives
+        const index_t threats = forced.fives(color ^ 1, fives);
+        if (threats > 1) {
+            results[color ^ 1] += LANES;
+            return;
+        }
+        if (!threats)
+            break;
+
+        forced.action(fives[0]);
+        played[fives[0]] = true;
+        any = true;
+    }
+
+    if (!any) {
+        simulate<LANES>(state, actions, count, results);
+        return;
+    }
+
+    // Keep the shuffled order of the fields still free
+    index_t remaining[Size * Size];
+    index_t left = 0;
+    for (index_t i = 0; i < count; i++)
+        if (!played[actions[i]])
+            remaining[left++] = actions[i];
+    simulate<LANES>(&forced, remaining, left, results);
+}
+#endif
+
+// Explicit template instantiation for compiled board sizes
+// and supported lane counts
+#ifndef SMALL_STATE
+#define INSTANTIATE_THREATS(SIZE, LANES) \
+    template void Rollout<SIZE>::simulateThreats<LANES>(State<SIZE>*, \
+        const Index<SIZE>*, Index<SIZE>, uint32_t[3]);
+#else
+#define INSTANTIATE_THREATS(SIZE, LANES)
+#endif
+
+#define INSTANTIATE(SIZE) \
+    template void Rollout<SIZE>::simulate<8>(State<SIZE>*, \
+        const Index<SIZE>*, Index<SIZE>, uint32_t[3]); \
+    template void Rollout<SIZE>::simulate<16>(State<SIZE>*, \
+        const Index<SIZE>*, Index<SIZE>, uint32_t[3]); \
+    template void Rollout<SIZE>::simulate<32>(State<SIZE>*, \
+        const Index<SIZE>*, Index<SIZE>, uint32_t[3]); \
+    INSTANTIATE_THREATS(SIZE, 8) \
+    INSTANTIATE_THREATS(SIZE, 16) \
+    INSTANTIATE_THREATS(SIZE, 32)
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
+#undef INSTANTIATE_THREATS
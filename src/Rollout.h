@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include <stdint.h>
+#include <vector>
+
+#include "Config.h"
+#include "State.h"
+
+using std::vector;
+
+
+/**
+ * Batched rollouts
+ * Plays LANES random playouts from the same state at once
+ *
+ * A playout which fills the board in a fixed order is decided by the
+ * first five cell window whose cells all receive the same color.
+ * Every lane assigns each empty cell the time it would be played,
+ * then all windows are scanned for the earliest single colored one.
+ * The scan is branch free and runs over all lanes in SIMD registers.
+*/
+template <uint8_t Size>
+class Rollout {
+ public:
+    typedef Index<Size> index_t;
+
+    /**
+     * Simulate LANES playouts from state
+     * Lane l plays actions cyclically from a random start index,
+     * exactly like the sequential Node::rollout
+     * Adds the outcome counts to results (0: p0win 1: p1win 2: draws)
+    */
+    template <uint8_t LANES>
+    static void simulate(State<Size>* state, const index_t* actions,
+        index_t count, uint32_t results[3]);
+
+    #ifndef SMALL_STATE
+    /**
+     * Simulate LANES threat aware playouts from state
+     * Forced moves are played first: a five of the player to move wins,
+     * otherwise a five of the opponent is blocked, until neither is left.
+     * The rest is played randomly like simulate.
+     * Adds the outcome counts to results (0: p0win 1: p1win 2: draws)
+    */
+    template <uint8_t LANES>
+    static void simulateThreats(State<Size>* state, const index_t* actions,
+        index_t count, uint32_t results[3]);
+    #endif
+
+ private:
+    /**
+     * Cells of a five stone window
+    */
+    struct Window {
+        index_t cells[5];
+    };
+
+    /**
+     * All windows of the board
+    */
+    static const vector<Window>& windows();
+};
@@ -0,0 +1,374 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Search.h"
+#include "Randomizer.h"
+#include "Arena.h"
+#include "Dev.h"
+#include "Timer.h"
+
+using std::to_string;
+using std::vector;
+using std::chrono::system_clock;
+using std::chrono::high_resolution_clock;
+using std::chrono::duration;
+
+void init() {
+    uint32_t seed = system_clock::now().time_since_epoch().count();
+    Randomizer::initialize(seed);
+    Arena::bind(0);
+}
+
+template <uint8_t Size>
+void initBoard() {
+    State<Size>::initZobrist();
+    Node<Size>::reserveTT(uint64_t(TABLE_MEMORY) << 20);
+
+    #ifdef RAVE
+    Node<Size>::resetRave();
+    #endif
+}
+
+template <uint8_t Size>
+bool MCTS_openBook() {
+    return Engine<Size>::local().book.open(OPENING_BOOK + to_string(Size) +
+        ".bin");
+}
+
+/**
+ * Arena bytes a search may fill, 0 for no limit
+*/
+uint64_t memoryLimit = 0;
+
+void MCTS_limitMemory(uint64_t bytes) {
+    memoryLimit = bytes;
+}
+
+template <uint8_t Size>
+Node<Size>* MCTS_root(State<Size> *root_state) {
+    Node<Size>* subtree = Engine<Size>::local().tree;
+
+    // Pondering may have swapped the arena pools on another thread
+    Arena::bind(0);
+
+    // Opponent replied since the last search
+    if (subtree && subtree->getEmpty() == root_state->getEmpty() + 1)
+        subtree = subtree->getChild(root_state->getLast());
+
+    if (subtree && subtree->getState()->getHash() == root_state->getHash())
+        return Node<Size>::promote(subtree);
+
+    // Unknown position, start over
+    Node<Size>::reset();
+    Arena::resetAll();
+    return new Node<Size>(*root_state);
+}
+
+template <uint8_t Size>
+void MCTS_master(Node<Size>* root, State<Size> *root_state) {
+    // Select best child
+    Node<Size>* best = root->absBestChild();
+
+    #ifdef ANALYTICS
+    // Print visits distribution
+    Analytics<Size>::visitsDist(root);
+
+    // Print evaluation distribution
+    Analytics<Size>::ucbDist(root);
+
+    // Print Rave distribution
+    #ifdef RAVE
+    Analytics<Size>::raveDist(root);
+    #endif
+
+    // Print overview
+    Analytics<Size>::overview(best);
+    #endif
+
+    (*root_state).action(best->getParentAction());
+
+    // Keep subtree of the played move for the next search
+    Engine<Size>::local().tree = best;
+}
+
+/**
+ * Play the book move instead of searching
+ * The tree is dropped, the next search starts over
+*/
+template <uint8_t Size>
+bool MCTS_book(State<Size> *root_state) {
+    Engine<Size>& engine = Engine<Size>::local();
+    Index<Size> move;
+    if (!engine.book.lookup(root_state, &move))
+        return false;
+
+    root_state->action(move);
+    engine.tree = nullptr;
+    return true;
+}
+
+#ifndef SMALL_STATE
+/**
+ * Play a forced win by continuous fours instead of searching
+ * Keeps the subtree of the move if the tree has one
+*/
+template <uint8_t Size>
+bool MCTS_forced(Node<Size>* root, State<Size> *root_state) {
+    Engine<Size>& engine = Engine<Size>::local();
+    Index<Size> move;
+    if (!engine.prover.win(root_state, VCF_ROOT, &move))
+        return false;
+
+    root_state->action(move);
+    engine.tree = root->getChild(move);
+    return true;
+}
+#endif
+
+uint32_t resolveThreads(uint32_t threads) {
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    return threads;
+}
+
+template <uint8_t Size, typename F>
+void runWorkers(uint32_t threads, F work) {
+    vector<std::thread> workers;
+    Arena::reserve(threads);
+
+    // Every worker gets its own rng stream of a seed drawn from ours
+    // and its own arena of our engine to allocate nodes from
+    const uint64_t seed = Randomizer::next();
+    Engine<Size>* engine = &Engine<Size>::local();
+    for (uint32_t i = 1; i < threads; i++) {
+        workers.emplace_back([work, seed, engine, i]() {
+            Randomizer::initialize(seed, i);
+            Engine<Size>::bind(engine, i);
+            work();
+        });
+    }
+
+    // Calling thread is the first worker
+    work();
+
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+template <uint8_t Size>
+uint64_t MCTS_move(State<Size> *root_state, uint64_t simulations,
+    uint32_t threads) {
+    if (simulations > MAX_SIMULATIONS)
+        throw std::invalid_argument("Simulations must be less than " +
+            to_string(MAX_SIMULATIONS) + "!");
+
+    if (MCTS_book(root_state))
+        return 0;
+
+    Node<Size>* root = MCTS_root(root_state);
+    #ifndef SMALL_STATE
+    if (MCTS_forced(root, root_state))
+        return 0;
+    #endif
+    const uint32_t reused = root->getVisits();
+
+    // Reused visits count towards the limit
+    simulations = std::min<uint64_t>(simulations, MAX_SIMULATIONS - reused);
+
+    // Build Tree
+    // Every rollout plays ROLLOUT_LANES simulations
+    atomic<uint64_t> started = 0;
+    runWorkers<Size>(resolveThreads(threads), [&]() {
+        while ((started += ROLLOUT_LANES) <= simulations) {
+            Node<Size>* node = root->policy();
+            node->rollout();
+        }
+    });
+
+    const uint64_t searched = root->getVisits() - reused;
+    MCTS_master(root, root_state);
+    return searched;
+}
+
+#ifdef EARLY_STOP
+/**
+ * Further search can not change the move anymore
+ * Either the root is proven, won or lost whatever we play,
+ * there is no choice,
+ * or the runner-up could not overtake the most visited child
+ * with the simulations expected until deadline
+*/
+template <uint8_t Size>
+bool MCTS_settled(Node<Size>* root, high_resolution_clock::time_point start,
+    uint32_t startVisits, high_resolution_clock::time_point deadline) {
+    if (root->getMoveCount() == 1 ||
+        root->getProof() != Node<Size>::UNPROVEN)
+        return true;
+
+    // Some children were never tried, with widening they would
+    // start without visits and can not overtake either
+    if (root->getUntried() && !Engine<Size>::local().widening)
+        return false;
+
+    uint32_t best = 0, second = 0;
+    Node<Size>** children = root->getChildren();
+    const Index<Size> count = root->getChildCount();
+    for (Index<Size> i = 0; i < count; i++) {
+        const uint32_t visits = children[i]->getVisits();
+        if (visits > best) {
+            second = best;
+            best = visits;
+        } else if (visits > second) {
+            second = visits;
+        }
+    }
+
+    // Simulation rate of this search so far
+    const auto now = high_resolution_clock::now();
+    const double elapsed = duration<double>(now - start).count();
+    const double left = duration<double>(deadline - now).count();
+    const double remaining = (root->getVisits() - startVisits) / elapsed *
+        left * EARLY_STOP;
+
+    return second + remaining < best;
+}
+#endif
+
+template <uint8_t Size>
+void MCTS_search(Node<Size>* root, high_resolution_clock::time_point deadline,
+    const atomic<bool>& stop, uint32_t threads) {
+    threads = resolveThreads(threads);
+
+    #ifdef EARLY_STOP
+    // Pondering runs without deadline and is never settled
+    const bool timed = deadline != high_resolution_clock::time_point::max();
+    const auto start = high_resolution_clock::now();
+    const uint32_t startVisits = root->getVisits();
+    #endif
+
+    // Iterations between checks of the simulation and memory limits
+    // Stopping is signalled by flags and checked every iteration
+    const int32_t batchSize = 1000;
+
+    // Simulations per batch of a single worker
+    const uint64_t batchSimulations = batchSize * ROLLOUT_LANES;
+
+    // Build Tree
+    // Reused visits count towards the limit
+    atomic<bool> capped = false;
+    const Timer timer(deadline);
+
+    runWorkers<Size>(threads, [&]() {
+        const auto stopped = [&]() {
+            return timer.expired() || stop.load(std::memory_order_relaxed) ||
+                capped.load(std::memory_order_relaxed);
+        };
+
+        uint32_t i;
+        while (!stopped()) {
+            for (i = 0; i < batchSize && !stopped(); i++) {
+                Node<Size>* node = root->policy();
+                node->rollout();
+            }
+
+            #ifdef EARLY_STOP
+            // Keep the remaining time for later moves
+            if (timed && MCTS_settled(root, start, startVisits, deadline)) {
+                capped = true;
+                break;
+            }
+            #endif
+
+            // Leave room for one more batch of every worker
+            if (root->getVisits() + threads * batchSimulations >
+                MAX_SIMULATIONS) {
+                if (!capped.exchange(true))
+                    fprintf(stderr, "Exiting due to MAX_SIMULATIONS!\n");
+                break;
+            }
+
+            // Workers fill their arenas at about the same rate
+            if (memoryLimit &&
+                Arena::local().getUsed() * threads > memoryLimit) {
+                if (!capped.exchange(true))
+                    fprintf(stderr, "Exiting due to memory limit!\n");
+                break;
+            }
+        }
+    });
+}
+
+template <uint8_t Size>
+uint64_t MCTS_move(State<Size> *root_state, milliseconds time,
+    uint32_t threads) {
+    const atomic<bool> stop = false;
+    return MCTS_move(root_state, time, stop, threads);
+}
+
+template <uint8_t Size>
+uint64_t MCTS_move(State<Size> *root_state, milliseconds time,
+    const atomic<bool>& stop, uint32_t threads) {
+    const auto deadline = high_resolution_clock::now() + time;
+    if (MCTS_book(root_state))
+        return 0;
+
+    Node<Size>* root = MCTS_root(root_state);
+    #ifndef SMALL_STATE
+    if (MCTS_forced(root, root_state))
+        return 0;
+    #endif
+    const uint32_t reused = root->getVisits();
+    MCTS_search(root, deadline, stop, threads);
+
+    const uint64_t searched = root->getVisits() - reused;
+    MCTS_master(root, root_state);
+    return searched;
+}
+
+#ifdef PONDER
+template <uint8_t Size>
+std::thread MCTS_ponder(const atomic<bool>& stop, uint32_t threads) {
+    const uint64_t seed = Randomizer::next();
+    Engine<Size>* engine = &Engine<Size>::local();
+
+    return std::thread([&stop, threads, seed, engine]() {
+        if (!engine->tree)
+            return;
+
+        Randomizer::initialize(seed);
+        Engine<Size>::bind(engine);
+
+        // Drop everything but the opponents options
+        engine->tree = Node<Size>::promote(engine->tree);
+        MCTS_search(engine->tree, high_resolution_clock::time_point::max(),
+            stop, threads);
+    });
+}
+#endif
+
+// Explicit template instantiation for compiled board sizes
+#ifdef PONDER
+#define INSTANTIATE_PONDER(SIZE) \
+    template std::thread MCTS_ponder<SIZE>(const atomic<bool>&, uint32_t);
+#else
+#define INSTANTIATE_PONDER(SIZE)
+#endif
+
+#define INSTANTIATE(SIZE) \
+    template void initBoard<SIZE>(); \
+    template bool MCTS_openBook<SIZE>(); \
+    template uint64_t MCTS_move<SIZE>(State<SIZE>*, uint64_t, uint32_t); \
+    template uint64_t MCTS_move<SIZE>(State<SIZE>*, milliseconds, uint32_t); \
+    template uint64_t MCTS_move<SIZE>(State<SIZE>*, milliseconds, \
+        const atomic<bool>&, uint32_t); \
+    INSTANTIATE_PONDER(SIZE)
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
+#undef INSTANTIATE_PONDER
@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+#include <stdint.h>
+#include <atomic>
+
+#include <chrono> //NOLINT
+#include <thread> //NOLINT
+
+#include "Config.h"
+#include "State.h"
+#include "Node.h"
+
+using std::atomic;
+using std::chrono::milliseconds;
+
+
+/**
+ * Seed the calling thread and bind it to the first arena
+*/
+void init();
+
+/**
+ * Prepare the zobrist keys of a board of Size
+ * and the engine bound to the calling thread
+*/
+template <uint8_t Size>
+void initBoard();
+
+/**
+ * Map OPENING_BOOK for a board of Size into the engine bound
+ * to the calling thread, false if there is none
+*/
+template <uint8_t Size>
+bool MCTS_openBook();
+
+/**
+ * Arena bytes a search may fill, 0 for no limit
+ * Searches stop early once their workers reach it
+*/
+void MCTS_limitMemory(uint64_t bytes);
+
+/**
+ * Search root_state for a fixed number of simulations
+ * and apply the best action to it
+ * Book moves and forced wins by continuous fours are played
+ * without searching
+ * Returns the simulations run, reused visits not included
+*/
+template <uint8_t Size>
+uint64_t MCTS_move(State<Size> *root_state, uint64_t simulations,
+    uint32_t threads = THREADS);
+
+/**
+ * Search root_state for time and apply the best action to it
+ * Book moves and forced wins by continuous fours are played
+ * without searching
+ * With EARLY_STOP the search ends as soon as the move is settled
+ * Returns the simulations run, reused visits not included
+*/
+template <uint8_t Size>
+uint64_t MCTS_move(State<Size> *root_state, milliseconds time,
+    uint32_t threads = THREADS);
+
+/**
+ * Search root_state for time or until stop is set, e.g. by another
+ * thread, and apply the best action to it
+ * Workers stop within one iteration of either
+*/
+template <uint8_t Size>
+uint64_t MCTS_move(State<Size> *root_state, milliseconds time,
+    const atomic<bool>& stop, uint32_t threads = THREADS);
+
+#ifdef PONDER
+/**
+ * Search the kept tree on the opponents time until stop is set
+ * The next MCTS_move picks up the subtree of the actual reply
+*/
+template <uint8_t Size>
+std::thread MCTS_ponder(const atomic<bool>& stop,
+    uint32_t threads = THREADS);
+#endif
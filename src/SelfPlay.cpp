@@ -0,0 +1,459 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+
+#include <chrono> //NOLINT
+#include <thread> //NOLINT
+
+#include "State.h"
+#include "Config.h"
+#include "Utilities.h"
+#include "Randomizer.h"
+#include "Engine.h"
+#include "Search.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using std::string;
+using std::vector;
+using std::ostringstream;
+using std::unique_ptr;
+using std::mutex;
+using std::lock_guard;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::chrono::milliseconds;
+
+/**
+ * Engine vs engine matches between two configurations
+ * Games run concurrently, each on one thread with its own engines,
+ * and the result is printed as a single JSON object
+ *
+ * Arguments are key=value pairs, a. and b. prefix the configurations:
+ *   a.sims / b.sims    simulations per move
+ *   a.time / b.time    milliseconds per move, replaces sims if set
+ *   a.bias / b.bias    exploration bias
+ *   a.k / b.k          rave constant
+ *   a.threats / b.threats  threat aware rollouts, 0 or 1
+ *   a.radius / b.radius    neighborhood of expanded moves, 0 for all
+ *   a.widening / b.widening    progressive widening factor, 0 for off
+ *   a.vcf / b.vcf      prover moves at new nodes, 0 for off
+ *   games, jobs, size, seed, table (TT MB per engine)
+ *   elo0, elo1, alpha, beta (SPRT hypotheses and error rates)
+*/
+
+/**
+ * Search settings of one side
+*/
+struct Config {
+    uint64_t simulations = 20000;
+    int64_t time = 0;
+    float bias = EXPLORATION_BIAS;
+    #ifdef RAVE
+    float k = K_PARAM;
+    #endif
+    uint8_t radius = NEIGHBORHOOD;
+    float widening = WIDENING;
+    #ifndef SMALL_STATE
+    #ifdef THREAT_ROLLOUTS
+    bool threats = true;
+    #else
+    bool threats = false;
+    #endif
+    uint32_t vcf = VCF_NODES;
+    #endif
+};
+
+struct Options {
+    Config configs[2];
+    uint32_t games = 100;
+    uint32_t jobs = 0;
+    int size = BOARD_SIZE;
+    uint64_t seed = 0x5eed;
+    uint64_t table = 16;
+    double elo0 = 0;
+    double elo1 = 5;
+    double alpha = 0.05;
+    double beta = 0.05;
+};
+
+/**
+ * Results from the view of configuration a
+*/
+struct Tally {
+    uint32_t wins = 0;
+    uint32_t draws = 0;
+    uint32_t losses = 0;
+    uint64_t simulations = 0;
+    uint64_t moves = 0;
+
+    uint32_t games() const { return wins + draws + losses; }
+};
+
+/**
+ * Elo difference of a score between 0 and 1
+*/
+double elo(double score) {
+    score = std::clamp(score, 1e-6, 1 - 1e-6);
+    return 400 * std::log10(score / (1 - score));
+}
+
+/**
+ * Score expected at an Elo difference
+*/
+double score(double elo) {
+    return 1 / (1 + std::pow(10, -elo / 400));
+}
+
+/**
+ * Mean and variance of the per game score
+*/
+void moments(const Tally& tally, double* mean, double* variance) {
+    const double n = tally.games();
+    *mean = (tally.wins + tally.draws / 2.0) / n;
+    *variance = (tally.wins * std::pow(1 - *mean, 2) +
+        tally.draws * std::pow(0.5 - *mean, 2) +
+        tally.losses * std::pow(*mean, 2)) / n;
+}
+
+/**
+ * Half width of the 95% confidence interval of the Elo difference
+*/
+double eloError(const Tally& tally) {
+    double mean, variance;
+    moments(tally, &mean, &variance);
+    const double deviation = 1.96 * std::sqrt(variance / tally.games());
+    return (elo(mean + deviation) - elo(mean - deviation)) / 2;
+}
+
+/**
+ * Log likelihood ratio of elo1 against elo0
+ * Normal approximation of the trinomial game results
+*/
+double llr(const Tally& tally, const Options& options) {
+    double mean, variance;
+    moments(tally, &mean, &variance);
+    if (variance <= 0)
+        return 0;
+
+    const double s0 = score(options.elo0);
+    const double s1 = score(options.elo1);
+    return (s1 - s0) * (2 * mean - s0 - s1) * tally.games() /
+        (2 * variance);
+}
+
+/**
+ * Bounds of the SPRT, crossing one accepts a hypothesis
+*/
+double lowerBound(const Options& options) {
+    return std::log(options.beta / (1 - options.alpha));
+}
+
+double upperBound(const Options& options) {
+    return std::log((1 - options.beta) / options.alpha);
+}
+
+/**
+ * Plays games and collects their results
+ * Shared by the job threads
+*/
+template <uint8_t Size>
+class Match {
+ public:
+    explicit Match(const Options& options)
+        : options(options), next(0), decided(false) {  }
+
+    /**
+     * Play games until all are taken or the SPRT is decided
+    */
+    void job();
+
+    Tally getTally() { return tally; }
+
+ private:
+    /**
+     * Play game, configuration a moves first in even games
+     * Returns the result of State::getResult
+    */
+    uint8_t play(uint32_t game, unique_ptr<Engine<Size>> engines[2],
+        Tally* local);
+
+    /**
+     * Record a finished game
+    */
+    void record(uint32_t game, bool aFirst, uint8_t result,
+        const Tally& local);
+
+    const Options& options;
+    mutex lock;
+    Tally tally;
+    uint32_t next;
+    bool decided;
+};
+
+template <uint8_t Size>
+void Match<Size>::job() {
+    // Engines are reused between games, keeping their memory
+    unique_ptr<Engine<Size>> engines[2];
+    for (uint8_t side = 0; side < 2; side++) {
+        engines[side] = std::make_unique<Engine<Size>>();
+        engines[side]->explorationBias = options.configs[side].bias;
+        #ifdef RAVE
+        engines[side]->raveK = options.configs[side].k;
+        #endif
+        engines[side]->radius = options.configs[side].radius;
+        engines[side]->widening = options.configs[side].widening;
+        #ifndef SMALL_STATE
+        engines[side]->threatRollouts = options.configs[side].threats;
+        engines[side]->vcfBudget = options.configs[side].vcf;
+        #endif
+
+        Engine<Size>::bind(engines[side].get());
+        Node<Size>::reserveTT(options.table << 20);
+    }
+
+    while (true) {
+        uint32_t game;
+        {
+            lock_guard<mutex> guard(lock);
+            if (decided || next >= options.games)
+                return;
+            game = next++;
+        }
+
+        Tally local;
+        const uint8_t result = play(game, engines, &local);
+        record(game, game % 2 == 0, result, local);
+    }
+}
+
+template <uint8_t Size>
+uint8_t Match<Size>::play(uint32_t game,
+    unique_ptr<Engine<Size>> engines[2], Tally* local) {
+    // Every engine gets its own stream, the same for a game in every run
+    Randomizer::Generator streams[2];
+    for (uint8_t side = 0; side < 2; side++) {
+        Randomizer::initialize(options.seed + game, side);
+        streams[side] = Randomizer::getRng();
+
+        // Forget the last game
+        engines[side]->tree = nullptr;
+    }
+
+    State<Size> state;
+    uint8_t side = game % 2;
+    while (!state.terminal()) {
+        const Config& config = options.configs[side];
+        Engine<Size>::bind(engines[side].get());
+        Randomizer::getRng() = streams[side];
+
+        local->simulations += config.time > 0 ?
+            MCTS_move(&state, milliseconds(config.time), 1) :
+            MCTS_move(&state, config.simulations, 1);
+        local->moves++;
+
+        streams[side] = Randomizer::getRng();
+        side ^= 1;
+    }
+
+    return state.getResult();
+}
+
+template <uint8_t Size>
+void Match<Size>::record(uint32_t game, bool aFirst, uint8_t result,
+    const Tally& local) {
+    lock_guard<mutex> guard(lock);
+
+    // Player 0 moves first
+    if (result == 2)
+        tally.draws++;
+    else if ((result == 0) == aFirst)
+        tally.wins++;
+    else
+        tally.losses++;
+    tally.simulations += local.simulations;
+    tally.moves += local.moves;
+
+    const double ratio = llr(tally, options);
+    decided = ratio <= lowerBound(options) || ratio >= upperBound(options);
+
+    cerr << "Game " << game + 1 << ": " << (aFirst ? "a" : "b")
+         << " first, " << (result == 2 ? "draw" :
+            (result == 0) == aFirst ? "a wins" : "b wins")
+         << " | W-D-L " << tally.wins << "-" << tally.draws << "-"
+         << tally.losses << " | Elo " << elo((tally.wins +
+            tally.draws / 2.0) / tally.games()) << " +- " << eloError(tally)
+         << " | LLR " << ratio << endl;
+}
+
+/**
+ * Print a configuration as JSON
+*/
+string describe(const Config& config) {
+    ostringstream json;
+    json << "{ \"simulations\": " << config.simulations
+         << ", \"time_ms\": " << config.time
+         << ", \"bias\": " << config.bias;
+    #ifdef RAVE
+    json << ", \"k\": " << config.k;
+    #endif
+    json << ", \"radius\": " << static_cast<int>(config.radius)
+         << ", \"widening\": " << config.widening;
+    #ifndef SMALL_STATE
+    json << ", \"threats\": " << (config.threats ? "true" : "false")
+         << ", \"vcf\": " << config.vcf;
+    #endif
+    json << " }";
+    return json.str();
+}
+
+template <uint8_t Size>
+void selfplay(const Options& options) {
+    State<Size>::initZobrist();
+
+    const uint32_t jobs = std::min(options.games, options.jobs ? options.jobs :
+        std::max(1u, std::thread::hardware_concurrency()));
+
+    Match<Size> match(options);
+    const auto start = steady_clock::now();
+    vector<std::thread> threads;
+    for (uint32_t i = 0; i < jobs; i++)
+        threads.emplace_back([&match]() { match.job(); });
+    for (std::thread& thread : threads)
+        thread.join();
+    const double time = duration<double>(steady_clock::now() - start).count();
+
+    const Tally tally = match.getTally();
+    const double ratio = llr(tally, options);
+    const char* verdict = ratio >= upperBound(options) ? "H1" :
+        ratio <= lowerBound(options) ? "H0" : "none";
+
+    cout << "{\n"
+         << "  \"board_size\": " << static_cast<int>(Size) << ",\n"
+         << "  \"a\": " << describe(options.configs[0]) << ",\n"
+         << "  \"b\": " << describe(options.configs[1]) << ",\n"
+         << "  \"jobs\": " << jobs << ",\n"
+         << "  \"games\": " << tally.games() << ",\n"
+         << "  \"wins\": " << tally.wins << ",\n"
+         << "  \"draws\": " << tally.draws << ",\n"
+         << "  \"losses\": " << tally.losses << ",\n"
+         << "  \"elo\": " << elo((tally.wins + tally.draws / 2.0) /
+            tally.games()) << ",\n"
+         << "  \"elo_error\": " << eloError(tally) << ",\n"
+         << "  \"llr\": " << ratio << ",\n"
+         << "  \"llr_bounds\": [" << lowerBound(options) << ", "
+         << upperBound(options) << "],\n"
+         << "  \"sprt\": \"" << verdict << "\",\n"
+         << "  \"moves\": " << tally.moves << ",\n"
+         << "  \"simulations_per_sec\": " << tally.simulations / time << ",\n"
+         << "  \"seconds\": " << time << "\n"
+         << "}" << endl;
+}
+
+/**
+ * Apply a key=value argument, false if unknown
+*/
+bool parse(const string& argument, Options* options) {
+    const size_t split = argument.find('=');
+    if (split == string::npos)
+        return false;
+
+    string key = argument.substr(0, split);
+    const char* value = argument.c_str() + split + 1;
+
+    // Configuration specific keys
+    if (key.size() > 2 && (key[0] == 'a' || key[0] == 'b') && key[1] == '.') {
+        Config& config = options->configs[key[0] - 'a'];
+        key = key.substr(2);
+        if (key == "sims")
+            config.simulations = strtoull(value, nullptr, 10);
+        else if (key == "time")
+            config.time = atoll(value);
+        else if (key == "bias")
+            config.bias = atof(value);
+        #ifdef RAVE
+        else if (key == "k")
+            config.k = atof(value);
+        #endif
+        else if (key == "radius")
+            config.radius = std::min(atoi(value), 7);
+        else if (key == "widening")
+            config.widening = atof(value);
+        #ifndef SMALL_STATE
+        else if (key == "threats")
+            config.threats = atoi(value);
+        else if (key == "vcf")
+            config.vcf = strtoul(value, nullptr, 10);
+        #endif
+        else
+            return false;
+        return true;
+    }
+
+    if (key == "games")
+        options->games = atoi(value);
+    else if (key == "jobs")
+        options->jobs = atoi(value);
+    else if (key == "size")
+        options->size = atoi(value);
+    else if (key == "seed")
+        options->seed = strtoull(value, nullptr, 10);
+    else if (key == "table")
+        options->table = strtoull(value, nullptr, 10);
+    else if (key == "elo0")
+        options->elo0 = atof(value);
+    else if (key == "elo1")
+        options->elo1 = atof(value);
+    else if (key == "alpha")
+        options->alpha = atof(value);
+    else if (key == "beta")
+        options->beta = atof(value);
+    else
+        return false;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        if (!parse(argv[i], &options)) {
+            cerr << "Unknown argument " << argv[i] << "!" << endl;
+            return 1;
+        }
+    }
+
+    for (const Config& config : options.configs) {
+        if (config.simulations > MAX_SIMULATIONS) {
+            cerr << "Simulations must be less than " << MAX_SIMULATIONS
+                << "!" << endl;
+            return 1;
+        }
+    }
+
+    if (!options.games)
+        return 0;
+
+    Randomizer::initialize(options.seed);
+
+    const int size = options.size;
+    const bool supported = 0 < size && size < 64 &&
+        withBoardSize(size, [&]<uint8_t Size>() { selfplay<Size>(options); });
+
+    if (!supported) {
+        cerr << "Unsupported board size " << size
+            << "! Compiled sizes: " << boardSizes() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include <atomic>
+
+
+/**
+ * Single byte test-and-test-and-set lock
+ * Used per node where a std::mutex would bloat the tree
+*/
+class Spinlock {
+ public:
+    void lock() {
+        while (flag.exchange(true, std::memory_order_acquire))
+            while (flag.load(std::memory_order_relaxed)) { }
+    }
+
+    bool try_lock() {
+        return !flag.load(std::memory_order_relaxed) &&
+            !flag.exchange(true, std::memory_order_acquire);
+    }
+
+    void unlock() {
+        flag.store(false, std::memory_order_release);
+    }
+
+ private:
+    std::atomic<bool> flag = false;
+};
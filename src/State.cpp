@@ -8,37 +8,67 @@
 /**
  * Initialize Zobrist Hashing Table
 */
-vector<vector<int64_t>> State::zobristTable(
-    BOARD_SIZE * BOARD_SIZE, vector<int64_t>(3));
+template <uint8_t Size>
+vector<vector<int64_t>> State<Size>::zobristTable(
+    Size * Size, vector<int64_t>(3));
 
-State::State()
-    : last(0), empty(BOARD_SIZE * BOARD_SIZE), result(2) {
-    memset(mArray, 0, sizeof(mArray));
-    memset(cArray, 0, sizeof(cArray));
+#ifdef SYMMETRY_HASH
+template <uint8_t Size>
+vector<uint64_t> State<Size>::symmetryKeys(Size * Size * 2 * 8);
+#endif
+
+template <uint8_t Size>
+State<Size>::State()
+    : last(0), empty(Size * Size), result(2) {
+    memset(sArray, 0, sizeof(sArray));
+    #ifndef SMALL_STATE
+    for (index_t i = 0; i < Size * Size; i++) {
+        cells[i] = i;
+        slots[i] = i;
+    }
+    #endif
     hashValue = hash();
+
+    // Every symmetry maps the empty board onto itself
+    #ifdef SYMMETRY_HASH
+    std::fill(symmetricHashes, symmetricHashes + 8, hashValue);
+    #endif
 }
 
-State::State(State* source)
+template <uint8_t Size>
+State<Size>::State(State* source)
     :   last(source->last), empty(source->empty), result(source->result),
         hashValue(source->hashValue) {
-    memcpy(mArray, source->mArray, sizeof(mArray));
-    memcpy(cArray, source->cArray, sizeof(cArray));
+    memcpy(sArray, source->sArray, sizeof(sArray));
+    #ifdef SYMMETRY_HASH
+    memcpy(symmetricHashes, source->symmetricHashes,
+        sizeof(symmetricHashes));
+    #endif
+    #ifndef SMALL_STATE
+    memcpy(cells, source->cells, sizeof(cells));
+    memcpy(slots, source->slots, sizeof(slots));
+    #endif
 }
 
-void State::action(const uint8_t x, const uint8_t y) {
+template <uint8_t Size>
+void State<Size>::action(const uint8_t x, const uint8_t y) {
     index_t index;
-    Utils::cordsToIndex(&index, x, y);
+    Utils<Size>::cordsToIndex(&index, x, y);
     action(index);
 }
 
-void State::action(const index_t index) {
+template <uint8_t Size>
+void State<Size>::action(const index_t index) {
     --empty;
     last = index;
     block_t x, y;
-    Utils::indexToCords(index, &x, &y);
+    Utils<Size>::indexToCords(index, &x, &y);
+
+    // Stones of the moving color
+    block_t* stones = sArray[empty % 2];
 
     // Horizontal
-    mArray[y] |= (block_t(1) << x);
+    stones[y] |= (block_t(1) << x);
 
     /**
      * This is effectively precomputing for consecutive stones check
@@ -46,17 +76,18 @@ void State::action(const index_t index) {
     */
     #ifndef SMALL_STATE
     // Vertical
-    mArray[x + BOARD_SIZE] |= (block_t(1) << y);
+    stones[x + Size] |= (block_t(1) << y);
     // LDiagonal
-    mArray[x + BOARD_SIZE - 1 - y + BOARD_SIZE * 2] |= (block_t(1) << x);
+    stones[x + Size - 1 - y + Size * 2] |= (block_t(1) << x);
     // RDiagonal
-    mArray[BOARD_SIZE - 1 - x + BOARD_SIZE - 1 - y + BOARD_SIZE * 4] |=
+    stones[Size - 1 - x + Size - 1 - y + Size * 4] |=
         (block_t(1) << x);
-    // Flip Colors
-    for (index_t i = 0; i < BOARD_SIZE * 6; i++) cArray[i] ^= mArray[i];
-    #else
-    // Flip Colors
-    for (index_t i = 0; i < BOARD_SIZE; i++) cArray[i] ^= mArray[i];
+
+    // Move last empty field into the freed slot
+    const index_t slot = slots[index];
+    const index_t moved = cells[empty];
+    cells[slot] = moved;
+    slots[moved] = slot;
     #endif
 
     // Update hash
@@ -66,54 +97,254 @@ void State::action(const index_t index) {
     else
         hashValue ^= zobristTable[index][2];
 
+    #ifdef SYMMETRY_HASH
+    const uint64_t* keys = &symmetryKeys[(index * 2 + empty % 2) * 8];
+    for (uint8_t s = 0; s < 8; s++)
+        symmetricHashes[s] ^= keys[s];
+    #endif
+
     // Check for 5-Stone alignment
     result = checkForFive() ? empty % 2 : 2;
 }
 
-std::vector<index_t> State::possible() {
+template <uint8_t Size>
+vector<Index<Size>> State<Size>::possible() {
     // Vector of possible actions
-    std::vector<index_t> actions;
+    std::vector<index_t> actions(empty);
+    possible(actions.data());
+    return actions;
+}
 
-    // Index of possible action
-    index_t index;
+#ifndef SMALL_STATE
+template <uint8_t Size>
+Index<Size> State<Size>::possible(index_t* actions) {
+    memcpy(actions, cells, sizeof(index_t) * empty);
+    return empty;
+}
+
+template <uint8_t Size>
+const Index<Size>* State<Size>::getEmptyCells() {
+    return cells;
+}
+
+template <uint8_t Size>
+Index<Size> State<Size>::randomEmpty() {
+    return cells[Randomizer::randomInt<index_t>(empty)];
+}
+
+template <uint8_t Size>
+uint16_t State<Size>::lineFives(uint8_t color, uint8_t direction,
+    uint8_t line, index_t* found) {
+    typedef std::make_unsigned_t<block_t> row_t;
+
+    // Word of the line in the bitboards and the bits on the board
+    // Diagonals are indexed by x, their cells run from first to last
+    uint16_t word;
+    int16_t first = 0, last = Size - 1;
+    const int16_t offset = line - (Size - 1);
+    switch (direction) {
+        case 0: word = line; break;
+        case 1: word = line + Size; break;
+        case 2:
+            word = line + Size * 2;
+            first = std::max<int16_t>(0, offset);
+            last = std::min<int16_t>(Size - 1, Size - 1 + offset);
+            break;
+        default:
+            word = Size - 1 + Size - 1 - line + Size * 4;
+            first = std::max<int16_t>(0, offset);
+            last = std::min<int16_t>(Size - 1, line);
+            break;
+    }
 
-    // Reserve enough space
-    actions.reserve(empty);
+    const row_t valid = ((row_t(2) << last) - 1) & ~((row_t(1) << first) - 1);
+    const row_t own = sArray[color][word];
+    const row_t free = valid & ~(own | static_cast<row_t>(
+        sArray[color ^ 1][word]));
+
+    // Bit i of l[k] / r[k] holds the stone k cells before / after i
+    const row_t l1 = own << 1, l2 = own << 2, l3 = own << 3, l4 = own << 4;
+    const row_t r1 = own >> 1, r2 = own >> 2, r3 = own >> 3, r4 = own >> 4;
+    row_t win = free & ((l1 & l2 & l3 & l4) | (l1 & l2 & l3 & r1) |
+        (l1 & l2 & r1 & r2) | (l1 & r1 & r2 & r3) | (r1 & r2 & r3 & r4));
+
+    uint16_t count = 0;
+    while (win) {
+        const uint8_t bit = std::countr_zero(win);
+        win &= win - 1;
+
+        uint8_t x = bit, y = line;
+        if (direction == 1) {
+            x = line;
+            y = bit;
+        } else if (direction == 2) {
+            y = bit - offset;
+        } else if (direction == 3) {
+            y = line - bit;
+        }
+        Utils<Size>::cordsToIndex(&found[count++], x, y);
+    }
+    return count;
+}
 
-    // Find empty fields
-    for (index_t x = 0; x < BOARD_SIZE; x++) {
-        for (index_t y = 0; y < BOARD_SIZE; y++) {
-            if (isEmpty(x, y)) {
-                Utils::cordsToIndex(&index, x, y);
-                actions.push_back(index);
+template <uint8_t Size>
+Index<Size> State<Size>::fives(uint8_t color, index_t* found) {
+    // A field completes five on one line at most once per direction,
+    // collect per line and drop the repeats of crossing lines
+    bool seen[Size * Size] = {};
+    index_t line[Size];
+    index_t count = 0;
+
+    for (uint8_t direction = 0; direction < 4; direction++) {
+        const uint8_t lines = direction < 2 ? Size : Size * 2 - 1;
+        for (uint8_t i = 0; i < lines; i++) {
+            const uint16_t n = lineFives(color, direction, i, line);
+            for (uint16_t j = 0; j < n; j++) {
+                if (!seen[line[j]]) {
+                    seen[line[j]] = true;
+                    found[count++] = line[j];
+                }
             }
         }
     }
+    return count;
+}
 
-    return actions;
+template <uint8_t Size>
+Index<Size> State<Size>::fives(uint8_t color, index_t field,
+    index_t* found) {
+    uint8_t x, y;
+    Utils<Size>::indexToCords(field, &x, &y);
+
+    // Lines through a stone only cross in the stone itself
+    const uint8_t lines[4] = { y, x, static_cast<uint8_t>(x - y + Size - 1),
+        static_cast<uint8_t>(x + y) };
+    index_t count = 0;
+    for (uint8_t direction = 0; direction < 4; direction++)
+        count += lineFives(color, direction, lines[direction], found + count);
+    return count;
+}
+#else
+template <uint8_t Size>
+Index<Size> State<Size>::possible(index_t* actions) {
+    typedef std::make_unsigned_t<block_t> row_t;
+    const row_t full = (row_t(1) << Size) - 1;
+
+    // Walk the free bits of every row
+    index_t count = 0;
+    for (uint8_t y = 0; y < Size; y++) {
+        row_t free = ~static_cast<row_t>(occupied(y)) & full;
+        while (free) {
+            Utils<Size>::cordsToIndex(&actions[count++],
+                static_cast<uint8_t>(std::countr_zero(free)), y);
+            free &= free - 1;
+        }
+    }
+
+    return count;
 }
+#endif
 
-bool State::terminal() {
+template <uint8_t Size>
+Index<Size> State<Size>::neighborhood(index_t* actions, uint8_t radius) {
+    typedef std::make_unsigned_t<block_t> row_t;
+    const row_t full = (row_t(1) << Size) - 1;
+
+    // Stones spread sideways first
+    row_t wide[Size];
+    bool stones = false;
+    for (uint8_t y = 0; y < Size; y++) {
+        const row_t row = occupied(y);
+        stones |= row != 0;
+        wide[y] = row;
+        for (uint8_t r = 1; r <= radius; r++)
+            wide[y] |= (row << r) | (row >> r);
+    }
+
+    if (!stones) {
+        Utils<Size>::cordsToIndex(&actions[0], Size / 2, Size / 2);
+        return 1;
+    }
+
+    // Then up and down
+    index_t count = 0;
+    for (uint8_t y = 0; y < Size; y++) {
+        const uint8_t top = y > radius ? y - radius : 0;
+        const uint8_t bottom = std::min<uint8_t>(Size - 1, y + radius);
+        row_t near = 0;
+        for (uint8_t row = top; row <= bottom; row++)
+            near |= wide[row];
+
+        near &= full & ~static_cast<row_t>(occupied(y));
+        while (near) {
+            Utils<Size>::cordsToIndex(&actions[count++],
+                static_cast<uint8_t>(std::countr_zero(near)), y);
+            near &= near - 1;
+        }
+    }
+
+    return count;
+}
+
+template <uint8_t Size>
+uint16_t State<Size>::prior(index_t field) {
+    // Score of a line by the stones in a row next to the field,
+    // own lines count more than the opponents, four means five
+    static const uint16_t weights[2][5] = {
+        { 0, 2, 8, 32, 1024 },
+        { 0, 1, 6, 24, 512 } };
+    static const int8_t dx[4] = { 1, 0, 1, 1 };
+    static const int8_t dy[4] = { 0, 1, 1, -1 };
+
+    uint8_t x, y;
+    Utils<Size>::indexToCords(field, &x, &y);
+    const uint8_t mover = (empty - 1) % 2;
+
+    uint16_t score = 0;
+    for (uint8_t color = 0; color < 2; color++) {
+        const block_t* stones = sArray[color];
+        for (uint8_t d = 0; d < 4; d++) {
+            uint8_t run = 0;
+            for (int8_t side = -1; side <= 1; side += 2) {
+                int8_t cx = x, cy = y;
+                for (uint8_t step = 0; step < 4; step++) {
+                    cx += side * dx[d];
+                    cy += side * dy[d];
+                    if (cx < 0 || cy < 0 || cx >= Size || cy >= Size ||
+                        !(stones[cy] & (block_t(1) << cx)))
+                        break;
+                    run++;
+                }
+            }
+            score += weights[color != mover][std::min<uint8_t>(run, 4)];
+        }
+    }
+    return score;
+}
+
+template <uint8_t Size>
+bool State<Size>::terminal() {
     return (empty == 0 || result < 2);
 }
 
-int8_t State::getCellValue(index_t index) {
+template <uint8_t Size>
+int8_t State<Size>::getCellValue(index_t index) {
     uint8_t x, y;
-    Utils::indexToCords(index, &x, &y);
+    Utils<Size>::indexToCords(index, &x, &y);
     return getCellValue(x, y);
 }
 
-int8_t State::getCellValue(uint8_t x, uint8_t y) {
-    if (mArray[y] & (block_t(1) << x)) {
-        if (cArray[y] & (block_t(1) << x))
-            return empty % 2;
-        return !(empty % 2);
-    }
-
+template <uint8_t Size>
+int8_t State<Size>::getCellValue(uint8_t x, uint8_t y) {
+    if (sArray[0][y] & (block_t(1) << x))
+        return 0;
+    if (sArray[1][y] & (block_t(1) << x))
+        return 1;
     return -1;
 }
 
-string State::toString() {
+template <uint8_t Size>
+string State<Size>::toString() {
     // Constants for rendering
     const string stoneBlack = " ● ";
     const string stoneWhite = " ● ";
@@ -122,9 +353,9 @@ string State::toString() {
     const string resetColor = "\033[0m";
 
     vector<vector<string>> cellValues;
-    for (int x = 0; x < BOARD_SIZE; x++) {
+    for (int x = 0; x < Size; x++) {
         vector<string> column;
-        for (int y = 0; y < BOARD_SIZE; y++) {
+        for (int y = 0; y < Size; y++) {
             string value;
             int8_t index_value = getCellValue(x, y);
             if (index_value == -1) {
@@ -143,29 +374,31 @@ string State::toString() {
         cellValues.push_back(column);
     }
 
-    return Utils::cellsToString(cellValues);
+    return Utils<Size>::cellsToString(cellValues);
 }
 
 
 #ifdef SMALL_STATE
-bool State::cellIsActiveColor(uint8_t x, uint8_t y) {
-    return (cArray[y] & (block_t(1) << x));
+template <uint8_t Size>
+bool State<Size>::cellIsActiveColor(uint8_t x, uint8_t y) {
+    return (sArray[empty % 2][y] & (block_t(1) << x));
 }
 
-bool State::checkForFive() {
+template <uint8_t Size>
+bool State<Size>::checkForFive() {
     uint8_t x, y;
-    Utils::indexToCords(last, &x, &y);
+    Utils<Size>::indexToCords(last, &x, &y);
 
     // Horizontal
     // This is still performant since it uses the original code for the check
-    block_t m = cArray[y];
+    block_t m = sArray[empty % 2][y];
     m = m & (m >> block_t(1));
     m = (m & (m >> block_t(2)));
     if (m & (m >> block_t(1))) return true;
 
     // Vertical
     int consecutive = 0;
-    for (int i = 0; i < BOARD_SIZE; i++) {
+    for (int i = 0; i < Size; i++) {
         if (cellIsActiveColor(x, i)) {
             consecutive++;
             if (consecutive == 5) return true;
@@ -181,7 +414,7 @@ bool State::checkForFive() {
         x1--;
         y1--;
     }
-    while (x1 < BOARD_SIZE && y1 < BOARD_SIZE) {
+    while (x1 < Size && y1 < Size) {
         if (cellIsActiveColor(x1, y1)) {
             consecutive++;
             if (consecutive == 5) return true;
@@ -195,11 +428,11 @@ bool State::checkForFive() {
     // Anti-Diagonal
     consecutive = 0;
     x1 = x, y1 = y;
-    while (x1 > 0 && y1 < BOARD_SIZE - 1) {
+    while (x1 > 0 && y1 < Size - 1) {
         x1--;
         y1++;
     }
-    while (x1 < BOARD_SIZE && y1 >= 0) {
+    while (x1 < Size && y1 >= 0) {
         if (cellIsActiveColor(x1, y1)) {
             consecutive++;
             if (consecutive == 5) return true;
@@ -213,83 +446,157 @@ bool State::checkForFive() {
     return false;
 }
 #else
-bool State::checkForFive() {
-    uint8_t x = last % BOARD_SIZE;
-    uint8_t y = last / BOARD_SIZE;
-#if BOARD_SIZE < 16
-    uint64_t m = ((uint64_t)cArray[y] << 48)
-        + ((uint64_t)cArray[x + BOARD_SIZE] << 32)
-        + ((uint64_t)cArray[x + BOARD_SIZE - 1 - y + BOARD_SIZE * 2] << 16)
-        + ((uint64_t)cArray[
-            BOARD_SIZE - 1 - x + BOARD_SIZE - 1 - y + BOARD_SIZE * 4]);
-
-    m &= (m >> uint64_t(1));
-    m &= (m >> uint64_t(2));
-    return (m & (m >> uint64_t(1)));
-#else
+template <uint8_t Size>
+bool State<Size>::checkForFive() {
+    uint8_t x = last % Size;
+    uint8_t y = last / Size;
+    const block_t* stones = sArray[empty % 2];
+
+    // All four lines fit into one word
+    if constexpr (Size < 16) {
+        uint64_t m = ((uint64_t)stones[y] << 48)
+            + ((uint64_t)stones[x + Size] << 32)
+            + ((uint64_t)stones[x + Size - 1 - y + Size * 2] << 16)
+            + ((uint64_t)stones[
+                Size - 1 - x + Size - 1 - y + Size * 4]);
+
+        m &= (m >> uint64_t(1));
+        m &= (m >> uint64_t(2));
+        return (m & (m >> uint64_t(1)));
+    }
+
     // Horizontal
-    block_t m = cArray[y];
+    block_t m = stones[y];
     m = m & (m >> block_t(1));
     m = (m & (m >> block_t(2)));
     if (m & (m >> block_t(1))) return true;
     // Vertical
-    m = cArray[x + BOARD_SIZE];
+    m = stones[x + Size];
     m = m & (m >> block_t(1));
     m = (m & (m >> block_t(2)));
     if (m & (m >> block_t(1))) return true;
     // LDiagonal
-    m = cArray[x + BOARD_SIZE - 1 - y + BOARD_SIZE * 2];
+    m = stones[x + Size - 1 - y + Size * 2];
     m = m & (m >> block_t(1));
     m = (m & (m >> block_t(2)));
     if (m & (m >> block_t(1))) return true;
     // RDiagonal
-    m = cArray[BOARD_SIZE - 1 - x + BOARD_SIZE - 1 - y + BOARD_SIZE * 4];
+    m = stones[Size - 1 - x + Size - 1 - y + Size * 4];
     m = m & (m >> block_t(1));
     m = (m & (m >> block_t(2)));
     if (m & (m >> block_t(1))) return true;
     return false;
-#endif
 }
 #endif
 
 // Gets value for empty field, updates progressively
-uint64_t State::hash() {
+template <uint8_t Size>
+uint64_t State<Size>::hash() {
     uint64_t hashValue = 0;
-    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; ++i)
+    for (int i = 0; i < Size * Size; ++i)
         hashValue ^= State::zobristTable[i][0];
     return hashValue;
 }
 
-void State::initZobrist() {
+template <uint8_t Size>
+void State<Size>::initZobrist() {
+    // Own generator with a fixed seed, stored hashes like the
+    // opening book stay valid and the search rng is left alone
+    Randomizer::Generator keys;
+    keys.seed(0x9e3779b97f4a7c15 ^ Size);
+
     // Init Zobrist Hashing Table
-    std::uniform_int_distribution<int64_t> distribution;
-    for (int i = 0; i < BOARD_SIZE * BOARD_SIZE; ++i)
+    for (int i = 0; i < Size * Size; ++i)
         for (int j = 0; j < 3; ++j)
-            zobristTable[i][j] = distribution(Randomizer::getRng());
+            zobristTable[i][j] = keys();
+
+    // Stone of color on field i changes hash s like the same stone
+    // on the field i is mapped to, colors use keys 2 and 1 in action
+    #ifdef SYMMETRY_HASH
+    for (int i = 0; i < Size * Size; ++i) {
+        for (uint8_t color = 0; color < 2; color++) {
+            for (uint8_t s = 0; s < 8; s++) {
+                const index_t field = Utils<Size>::transform(i, s);
+                symmetryKeys[(i * 2 + color) * 8 + s] =
+                    zobristTable[field][0] ^ zobristTable[field][2 - color];
+            }
+        }
+    }
+    #endif
 }
 
-bool State::isEmpty(const index_t index) {
+template <uint8_t Size>
+bool State<Size>::isEmpty(const index_t index) {
     uint8_t x, y;
-    Utils::indexToCords(index, &x, &y);
+    Utils<Size>::indexToCords(index, &x, &y);
     return isEmpty(x, y);
 }
 
-bool State::isEmpty(const uint8_t x, const uint8_t y) {
-    return !(mArray[y] & (block_t(1) << x));
+template <uint8_t Size>
+bool State<Size>::isEmpty(const uint8_t x, const uint8_t y) {
+    return !(occupied(y) & (block_t(1) << x));
+}
+
+template <uint8_t Size>
+Block<Size> State<Size>::occupied(const uint8_t y) {
+    return sArray[0][y] | sArray[1][y];
 }
 
-uint8_t State::getResult() {
+template <uint8_t Size>
+uint8_t State<Size>::getResult() {
     return result;
 }
 
-index_t State::getLast() {
+template <uint8_t Size>
+Index<Size> State<Size>::getLast() {
     return last;
 }
 
-index_t State::getEmpty() {
+template <uint8_t Size>
+Index<Size> State<Size>::getEmpty() {
     return empty;
 }
 
-uint64_t State::getHash() {
+template <uint8_t Size>
+uint64_t State<Size>::getHash() {
     return hashValue;
 }
+
+#ifdef SYMMETRY_HASH
+template <uint8_t Size>
+uint64_t State<Size>::canonicalHash(uint8_t* symmetry) {
+    *symmetry = std::min_element(symmetricHashes, symmetricHashes + 8) -
+        symmetricHashes;
+    return symmetricHashes[*symmetry];
+}
+
+template <uint8_t Size>
+uint64_t State<Size>::getKey() {
+    return *std::min_element(symmetricHashes, symmetricHashes + 8);
+}
+#else
+template <uint8_t Size>
+uint64_t State<Size>::canonicalHash(uint8_t* symmetry) {
+    // Keys like action uses them, the identity gives getHash()
+    uint64_t hashes[8] = {};
+    for (index_t i = 0; i < Size * Size; i++) {
+        const int8_t color = getCellValue(i);
+        const uint8_t key = color < 0 ? 0 : 2 - color;
+        for (uint8_t s = 0; s < 8; s++)
+            hashes[s] ^= zobristTable[Utils<Size>::transform(i, s)][key];
+    }
+
+    *symmetry = std::min_element(hashes, hashes + 8) - hashes;
+    return hashes[*symmetry];
+}
+
+template <uint8_t Size>
+uint64_t State<Size>::getKey() {
+    return hashValue;
+}
+#endif
+
+// Explicit template instantiation for compiled board sizes
+#define INSTANTIATE(SIZE) template class State<SIZE>;
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
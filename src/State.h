@@ -8,8 +8,10 @@
 #include <vector>
 #include <string>
 #include <cstring>
-#include <random>
 #include <sstream>
+#include <bit>
+#include <algorithm>
+#include <type_traits>
 
 #include "Config.h"
 #include "Randomizer.h"
@@ -35,27 +37,30 @@ oooo            xxoo            xooo            xxxo
 
 
 /**
- * Bitmask for stone / no stone
+ * Bitmask for stone / no stone of a board of Size
 */
 
 // TODO: Figure out why we need to do >= instead of just >
-#if BOARD_SIZE >= 32
-typedef int64_t block_t;
-#elif BOARD_SIZE >= 16
-typedef int32_t block_t;
-#elif BOARD_SIZE >= 8
-typedef int16_t block_t;
-#else
-typedef int8_t block_t;
-#endif
+template <uint8_t Size>
+using Block =
+    std::conditional_t<(Size >= 32), int64_t,
+    std::conditional_t<(Size >= 16), int32_t,
+    std::conditional_t<(Size >= 8), int16_t,
+    int8_t>>>;
 
 
 /**
- * Game state
+ * Game state on a board of Size
  * Speed optimized for MCTS
 */
+template <uint8_t Size>
 class State {
+    static_assert(4 < Size && Size < 64, "Unsupported board size");
+
  public:
+    typedef Index<Size> index_t;
+    typedef Block<Size> block_t;
+
     /**
     * Default constructor
     */
@@ -81,6 +86,53 @@ class State {
     */
     vector<index_t> possible();
 
+    /**
+     * Write remaining empty fields into actions
+     * actions must hold getEmpty() entries, returns getEmpty()
+    */
+    index_t possible(index_t* actions);
+
+    /**
+     * Write empty fields within radius of a stone into actions
+     * Distance counts king moves, found by dilating the rows
+     * On an empty board the center is the only field
+     * actions must hold getEmpty() entries, returns how many were written
+    */
+    index_t neighborhood(index_t* actions, uint8_t radius);
+
+    /**
+     * Cheap score of playing the empty field for the player to move
+     * Sums the stones each color has in a row next to it per line,
+     * so fields extending or blocking longer lines score higher
+    */
+    uint16_t prior(index_t field);
+
+    #ifndef SMALL_STATE
+    /**
+     * Remaining empty fields, the first getEmpty() entries are valid
+     * Zero copy, invalidated by the next action
+    */
+    const index_t* getEmptyCells();
+
+    /**
+     * Uniformly random empty field
+    */
+    index_t randomEmpty();
+
+    /**
+     * Empty fields where color would complete five, on the whole board
+     * found must hold getEmpty() entries, returns how many were written
+    */
+    index_t fives(uint8_t color, index_t* found);
+
+    /**
+     * Empty fields where color would complete five on the four lines
+     * through the stone at field, each written once
+     * found must hold 4 * Size entries, returns how many were written
+    */
+    index_t fives(uint8_t color, index_t field, index_t* found);
+    #endif
+
     /**
      * Check if state is terminal
     */
@@ -93,6 +145,7 @@ class State {
 
     /**
      * Init zobrist hash table
+     * Keys are fixed, so hashes are the same in every run
     */
     static void initZobrist();
 
@@ -116,6 +169,20 @@ class State {
     */
     uint64_t getHash();
 
+    /**
+     * Smallest hash among the eight rotations and reflections
+     * of the board, symmetry is set to the one producing it
+     * Kept up to date by action with SYMMETRY_HASH,
+     * recomputed from the stones otherwise
+    */
+    uint64_t canonicalHash(uint8_t* symmetry);
+
+    /**
+     * Key of the state in the transposition table
+     * The canonical hash with SYMMETRY_HASH, the hash otherwise
+    */
+    uint64_t getKey();
+
     /**
      * Is cell empty
     */
@@ -147,21 +214,42 @@ class State {
     */
     bool cellIsActiveColor(uint8_t x, uint8_t y);
 
+    /**
+     * Bitmask for stone / no stone in row y
+    */
+    block_t occupied(uint8_t y);
+
+    #ifndef SMALL_STATE
+    /**
+     * Empty fields where color would complete five on one line
+     * direction: 0 Horizontal, 1 Vertical, 2 LDiagonal, 3 RDiagonal
+     * line: y, x, x - y + Size - 1 and x + y respectively
+     * Writes them to found, returns how many were written
+    */
+    uint16_t lineFives(uint8_t color, uint8_t direction, uint8_t line,
+        index_t* found);
+    #endif
+
     /**
     * Calculate inital hash value
     */
     uint64_t hash();
 
     /**
-     * Bitmask for stone / no stone
-     * Bitmask for color
+     * Bitmask of stones per color
+     * A move only touches the words of its own color
     */
     #ifdef SMALL_STATE
-    block_t mArray[BOARD_SIZE];
-    block_t cArray[BOARD_SIZE];
+    block_t sArray[2][Size];
     #else
-    block_t mArray[BOARD_SIZE * 6];
-    block_t cArray[BOARD_SIZE * 6];
+    block_t sArray[2][Size * 6];
+
+    /**
+     * Empty fields packed in front, updated in O(1) per action
+     * cells[slots[i]] == i for every empty field i
+    */
+    index_t cells[Size * Size];
+    index_t slots[Size * Size];
     #endif
 
     /**
@@ -185,6 +273,20 @@ class State {
     */
     uint64_t hashValue;
 
+    #ifdef SYMMETRY_HASH
+    /**
+     * Hash of the board seen through each symmetry
+     * Index 0 is the identity and equals hashValue
+    */
+    uint64_t symmetricHashes[8];
+
+    /**
+     * Change of the symmetric hashes by a stone,
+     * the 8 keys of field and color lie next to each other
+    */
+    static vector<uint64_t> symmetryKeys;
+    #endif
+
     /**
      * Zobrist hash table
     */
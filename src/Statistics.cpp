@@ -6,17 +6,26 @@
 #include "Statistics.h"
 
 
-Statistics::Statistics()
-    : state(new State()), visits(0) {
-    memset(results, 0, sizeof(uint32_t) * 3);
-}
+template <uint8_t Size>
+Statistics<Size>::Statistics()
+    : state(new State<Size>()), visits(0), results{0, 0, 0} {  }
 
-Statistics::Statistics(State state)
-    : state(state), visits(0) {
-    memset(results, 0, sizeof(uint32_t) * 3);
-}
+template <uint8_t Size>
+Statistics<Size>::Statistics(State<Size> state)
+    : state(state), visits(0), results{0, 0, 0} {  }
 
-Statistics::Statistics(Statistics* source)
-    : state(State(source->state)), visits(source->visits) {
-    memcpy(results, source->results, sizeof(uint32_t) * 3);
+template <uint8_t Size>
+void* Statistics<Size>::operator new(size_t size) {
+    return Arena::local().allocate(size, alignof(Statistics));
 }
+
+template <uint8_t Size>
+Statistics<Size>::Statistics(Statistics* source)
+    : state(State<Size>(source->state)), visits(source->visits.load()),
+      results{source->results[0].load(), source->results[1].load(),
+              source->results[2].load()} {  }
+
+// Explicit template instantiation for compiled board sizes
+#define INSTANTIATE(SIZE) template class Statistics<SIZE>;
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
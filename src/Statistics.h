@@ -5,32 +5,43 @@
  */
 
 
+#include <atomic>
+
 #include "State.h"
+#include "Arena.h"
 
 
 /**
  * Cross Node state data
  * Used to sync data between nodes which have the same state
 */
+template <uint8_t Size>
 class Statistics {
  public:
     /**
      * Current state
     */
-    State state;
+    State<Size> state;
 
     /**
      * Number of visits
     */
-    uint32_t visits;
+    std::atomic<uint32_t> visits;
 
     /**
      * Results of simulations
      * 0: p0win 1: p1win 2: draws
     */
-    uint32_t results[3];
+    std::atomic<uint32_t> results[3];
 
     Statistics();
-    explicit Statistics(State);
+    explicit Statistics(State<Size>);
     explicit Statistics(Statistics*);
+
+    /**
+     * Statistics live in the calling threads arena
+     * Released all at once by Arena::resetAll
+    */
+    static void* operator new(size_t size);
+    static void operator delete(void*) {  }
 };
@@ -0,0 +1,99 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include "ThreatSpace.h"
+
+#ifndef SMALL_STATE
+static_assert((VCF_TABLE & (VCF_TABLE - 1)) == 0,
+    "VCF_TABLE must be a power of two");
+
+template <uint8_t Size>
+ThreatSpace<Size>::ThreatSpace()
+    : failed(new atomic<uint64_t>[VCF_TABLE]()) {  }
+
+template <uint8_t Size>
+bool ThreatSpace<Size>::win(State<Size>* state, uint32_t budget,
+    index_t* move) {
+    if (!budget || state->terminal())
+        return false;
+
+    const uint8_t attacker = (state->getEmpty() - 1) % 2;
+    index_t found[Size * Size];
+
+    // Five on the spot
+    if (state->fives(attacker, found)) {
+        *move = found[0];
+        return true;
+    }
+
+    // Two fives of the defender can not both be blocked
+    const index_t threats = state->fives(attacker ^ 1, found);
+    if (threats > 1)
+        return false;
+
+    return attack(state, threats ? found[0] : -1, &budget, move);
+}
+
+template <uint8_t Size>
+bool ThreatSpace<Size>::attack(State<Size>* state, int16_t threat,
+    uint32_t* budget, index_t* move) {
+    const uint64_t hash = state->getHash();
+    atomic<uint64_t>& entry = failed[hash & (VCF_TABLE - 1)];
+    if (entry.load(std::memory_order_relaxed) == hash)
+        return false;
+
+    // Every four has another of its stones within two fields
+    const uint8_t attacker = (state->getEmpty() - 1) % 2;
+    index_t candidates[Size * Size];
+    index_t count = 1;
+    if (threat >= 0)
+        candidates[0] = threat;
+    else
+        count = state->neighborhood(candidates, 2);
+
+    index_t fives[4 * Size];
+    index_t blocks[4 * Size];
+    for (index_t i = 0; i < count; i++) {
+        if (!*budget)
+            return false;
+        --*budget;
+
+        State<Size> next(*state);
+        next.action(candidates[i]);
+
+        // Earlier fives of the attacker were blocked,
+        // so new ones are on the lines through the move
+        const index_t fours = next.fives(attacker, candidates[i], fives);
+        if (!fours)
+            continue;
+        if (fours > 1) {
+            *move = candidates[i];
+            return true;
+        }
+
+        // Forced block, which may make a four of the defender
+        next.action(fives[0]);
+        const index_t counters = next.fives(attacker ^ 1, fives[0], blocks);
+        if (counters > 1)
+            continue;
+
+        index_t reply;
+        if (attack(&next, counters ? blocks[0] : -1, budget, &reply)) {
+            *move = candidates[i];
+            return true;
+        }
+    }
+
+    // Only a complete search proves there is nothing
+    if (*budget)
+        entry.store(hash, std::memory_order_relaxed);
+    return false;
+}
+
+// Explicit template instantiation for compiled board sizes
+#define INSTANTIATE(SIZE) template class ThreatSpace<SIZE>;
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
+#endif
@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+
+#include "Config.h"
+#include "State.h"
+
+using std::atomic;
+using std::unique_ptr;
+
+
+#ifndef SMALL_STATE
+/**
+ * Threat space search for victories by continuous fours (VCF)
+ * The attacker, the player to move, only plays moves making a four,
+ * so the defender has to block the one field completing it.
+ * A move completing five on two fields at once wins. A four the
+ * defender makes while blocking has to be answered next.
+ *
+ * Positions without VCF are remembered in a small lock-free table,
+ * searches cut short by their budget remember nothing.
+*/
+template <uint8_t Size>
+class ThreatSpace {
+ public:
+    typedef Index<Size> index_t;
+
+    ThreatSpace();
+
+    /**
+     * Search a forced win of the player to move trying at most
+     * budget moves, writes the first move of the win to move
+     * Safe to call concurrently
+    */
+    bool win(State<Size>* state, uint32_t budget, index_t* move);
+
+ private:
+    /**
+     * Attack from state, threat is the field completing five for
+     * the defender which has to be blocked, -1 if there is none
+     * Neither player may have another field completing five
+    */
+    bool attack(State<Size>* state, int16_t threat, uint32_t* budget,
+        index_t* move);
+
+    /**
+     * Hashes of positions without VCF, indexed by their low bits
+    */
+    unique_ptr<atomic<uint64_t>[]> failed;
+};
+#endif
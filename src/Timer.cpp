@@ -0,0 +1,31 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include "Timer.h"
+
+
+Timer::Timer(high_resolution_clock::time_point deadline)
+    : flag(false), cancelled(false) {
+    if (deadline == high_resolution_clock::time_point::max())
+        return;
+
+    thread = std::thread([this, deadline]() {
+        std::unique_lock<std::mutex> guard(lock);
+        if (!wake.wait_until(guard, deadline, [this]() { return cancelled; }))
+            flag.store(true, std::memory_order_relaxed);
+    });
+}
+
+Timer::~Timer() {
+    if (!thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        cancelled = true;
+    }
+    wake.notify_one();
+    thread.join();
+}
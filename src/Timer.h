@@ -0,0 +1,52 @@
+#pragma once
+
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include <chrono> //NOLINT
+#include <thread> //NOLINT
+
+using std::atomic;
+using std::chrono::high_resolution_clock;
+
+
+/**
+ * Raises a flag at a deadline from a background thread
+ * Searches poll the flag with a relaxed load instead of reading the clock,
+ * so they stop within one iteration of the deadline
+*/
+class Timer {
+ public:
+    /**
+     * Start waiting for deadline, the maximum time point never fires
+    */
+    explicit Timer(high_resolution_clock::time_point deadline);
+
+    /**
+     * Cancel the wait if it is still running
+    */
+    ~Timer();
+
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+
+    /**
+     * Deadline was reached
+    */
+    bool expired() const {
+        return flag.load(std::memory_order_relaxed);
+    }
+
+ private:
+    atomic<bool> flag;
+    bool cancelled;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread thread;
+};
@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include "TranspositionTable.h"
+
+
+template <uint8_t Size>
+TranspositionTable<Size>::TranspositionTable()
+    : buckets(nullptr), mask(0), generation(GENERATIONS), replacements(0) {  }
+
+template <uint8_t Size>
+TranspositionTable<Size>::~TranspositionTable() {
+    delete[] buckets;
+}
+
+template <uint8_t Size>
+void TranspositionTable<Size>::reserve(uint64_t bytes) {
+    // Largest power of two buckets within the budget
+    uint64_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= bytes)
+        count <<= 1;
+
+    delete[] buckets;
+    buckets = new Bucket[count];
+    mask = count - 1;
+
+    // Wipe the fresh memory
+    generation = GENERATIONS;
+    clear();
+}
+
+template <uint8_t Size>
+void TranspositionTable<Size>::clear() {
+    replacements = 0;
+
+    if (++generation <= GENERATIONS)
+        return;
+
+    // Generations wrapped around, old keys would become valid again
+    generation = 1;
+    for (uint64_t i = 0; i <= mask && buckets; i++) {
+        for (uint8_t way = 0; way < WAYS; way++) {
+            buckets[i].keys[way].store(EMPTY, std::memory_order_relaxed);
+            buckets[i].values[way].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+}
+
+template <uint8_t Size>
+uint64_t TranspositionTable<Size>::getReplacements() {
+    return replacements;
+}
+
+template <uint8_t Size>
+double TranspositionTable<Size>::getOccupancy() {
+    if (!buckets)
+        return 0;
+
+    const uint64_t samples = std::min(SAMPLES, mask + 1);
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < samples; i++) {
+        for (uint8_t way = 0; way < WAYS; way++) {
+            const uint64_t key =
+                buckets[i].keys[way].load(std::memory_order_relaxed);
+            used += key != BUSY && !isFree(key);
+        }
+    }
+
+    return used * 100 / static_cast<double>(samples * WAYS);
+}
+
+template <uint8_t Size>
+uint64_t TranspositionTable<Size>::getBytes() {
+    return buckets ? (mask + 1) * sizeof(Bucket) : 0;
+}
+
+// Explicit template instantiation for compiled board sizes
+#define INSTANTIATE(SIZE) template class TranspositionTable<SIZE>;
+BOARD_SIZES(INSTANTIATE)
+#undef INSTANTIATE
@@ -0,0 +1,208 @@
+#pragma once
+
+/**
+ * Copyright (c) Alexander Kurtz 2023
+ */
+
+
+#include <stdint.h>
+#include <atomic>
+#include <algorithm>
+
+#include "Config.h"
+#include "Statistics.h"
+
+using std::atomic;
+
+
+/**
+ * Lock-free open addressed transposition table
+ * Maps state keys (State::getKey) to shared statistics
+ * Every bucket is exactly one cache line, so a lookup
+ * usually costs a single cache miss
+ *
+ * The table has a fixed byte budget. Keys carry the generation of the
+ * search which stored them, entries of older generations count as free.
+ * When every probed slot is taken, the least visited entry of the home
+ * bucket is replaced.
+*/
+template <uint8_t Size>
+class TranspositionTable {
+ public:
+    TranspositionTable();
+    ~TranspositionTable();
+
+    /**
+     * Allocate as many buckets as fit into bytes, at least one
+     * Not thread safe, drops all entries
+    */
+    void reserve(uint64_t bytes);
+
+    /**
+     * Remove all entries by starting a new generation
+     * Only wipes the memory once the generations wrap around
+     * Not thread safe
+    */
+    void clear();
+
+    /**
+     * Find statistics for hash or insert the result of create()
+     * Safe to call concurrently, create() may run twice for a hash
+     * racing with itself, which only costs sharing
+     * Sets found if the statistics already existed
+     * Returns nullptr if every probed slot is being written
+    */
+    template <typename F>
+    Statistics<Size>* findOrInsert(uint64_t hash, F create, bool* found);
+
+    /**
+     * Entries replaced since the last clear
+    */
+    uint64_t getReplacements();
+
+    /**
+     * Percentage of slots holding current entries
+     * Sampled from the first buckets
+    */
+    double getOccupancy();
+
+    /**
+     * Bytes held by the table
+    */
+    uint64_t getBytes();
+
+ private:
+    /**
+     * Entries per bucket
+    */
+    static constexpr uint8_t WAYS = 4;
+
+    /**
+     * Buckets probed before replacing
+    */
+    static constexpr uint8_t PROBES = 8;
+
+    /**
+     * Buckets sampled by getOccupancy
+    */
+    static constexpr uint64_t SAMPLES = 1024;
+
+    /**
+     * Low key bits hold the generation, 1 to GENERATIONS
+    */
+    static constexpr uint64_t GENERATION_MASK = 0xFF;
+    static constexpr uint64_t GENERATIONS = 0xFE;
+
+    /**
+     * Key 0 marks a never used slot
+    */
+    static constexpr uint64_t EMPTY = 0;
+
+    /**
+     * Slot claimed by a writer, its value is about to change
+    */
+    static constexpr uint64_t BUSY = ~uint64_t(0);
+
+    struct alignas(64) Bucket {
+        atomic<uint64_t> keys[WAYS];
+        atomic<Statistics<Size>*> values[WAYS];
+    };
+
+    /**
+     * Key of a slot is free to take in the current generation
+    */
+    bool isFree(uint64_t key);
+
+    /**
+     * Write value and key into a claimed slot
+    */
+    void publish(Bucket& bucket, uint8_t way, uint64_t key,
+        Statistics<Size>* value);
+
+    Bucket* buckets;
+    uint64_t mask;
+    uint64_t generation;
+    atomic<uint64_t> replacements;
+};
+
+
+template <uint8_t Size>
+inline bool TranspositionTable<Size>::isFree(uint64_t key) {
+    return key != BUSY && (key & GENERATION_MASK) != generation;
+}
+
+template <uint8_t Size>
+inline void TranspositionTable<Size>::publish(Bucket& bucket, uint8_t way,
+    uint64_t key, Statistics<Size>* value) {
+    bucket.values[way].store(value, std::memory_order_release);
+    bucket.keys[way].store(key, std::memory_order_release);
+}
+
+template <uint8_t Size>
+template <typename F>
+Statistics<Size>* TranspositionTable<Size>::findOrInsert(uint64_t hash,
+    F create, bool* found) {
+    // Tag the hash with the current generation
+    const uint64_t key = (hash & ~GENERATION_MASK) | generation;
+    *found = false;
+
+    for (uint8_t probe = 0; probe < PROBES; probe++) {
+        Bucket& bucket = buckets[(hash + probe) & mask];
+
+        for (uint8_t way = 0; way < WAYS; way++) {
+            uint64_t current = bucket.keys[way].load(std::memory_order_acquire);
+
+            // Entries are never removed within a generation,
+            // so the hash can not be stored behind a free slot
+            if (isFree(current)) {
+                if (!bucket.keys[way].compare_exchange_strong(current, BUSY,
+                    std::memory_order_acq_rel))
+                    continue;
+                Statistics<Size>* value = create();
+                publish(bucket, way, key, value);
+                return value;
+            }
+
+            if (current != key)
+                continue;
+
+            // Make sure the slot was not replaced while reading it
+            Statistics<Size>* value =
+                bucket.values[way].load(std::memory_order_acquire);
+            if (bucket.keys[way].load(std::memory_order_acquire) == key &&
+                value->state.getKey() == hash) {
+                *found = true;
+                return value;
+            }
+        }
+    }
+
+    // Replace the least visited entry of the home bucket
+    Bucket& bucket = buckets[hash & mask];
+    uint8_t victim = WAYS;
+    uint32_t fewest = UINT32_MAX;
+    for (uint8_t way = 0; way < WAYS; way++) {
+        const uint64_t current =
+            bucket.keys[way].load(std::memory_order_acquire);
+        if (current == BUSY)
+            continue;
+        const uint32_t visits = isFree(current) ? 0 :
+            bucket.values[way].load(std::memory_order_acquire)->visits.load(
+                std::memory_order_relaxed);
+        if (visits < fewest) {
+            fewest = visits;
+            victim = way;
+        }
+    }
+
+    uint64_t current = victim < WAYS ?
+        bucket.keys[victim].load(std::memory_order_acquire) : BUSY;
+    if (current == BUSY || !bucket.keys[victim].compare_exchange_strong(
+        current, BUSY, std::memory_order_acq_rel))
+        return nullptr;
+
+    replacements.fetch_add(1, std::memory_order_relaxed);
+    Statistics<Size>* value = create();
+    publish(bucket, victim, key, value);
+    return value;
+}
@@ -8,6 +8,8 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <bit>
+#include <utility>
 
 #include "Config.h"
 
@@ -18,18 +20,66 @@ using std::endl;
 using std::to_string;
 
 
+/**
+ * Board helpers for a board of Size
+*/
+template <uint8_t Size>
 class Utils {
  public:
+    typedef Index<Size> index_t;
+
     template <typename T>
     static void indexToCords(const index_t index, T *x, T *y) {
-        *x = index % BOARD_SIZE;
-        *y = index / BOARD_SIZE;
+        *x = index % Size;
+        *y = index / Size;
     }
 
 
     template <typename T>
     static void cordsToIndex(index_t *index, const T x, const T y) {
-        (*index) = y * BOARD_SIZE + x;
+        (*index) = y * Size + x;
+    }
+
+    /**
+     * Map index through one of the eight symmetries of the board
+     * Bit 0 mirrors x, bit 1 mirrors y, bit 2 then swaps x and y
+    */
+    static index_t transform(const index_t index, const uint8_t symmetry) {
+        uint8_t x, y;
+        indexToCords(index, &x, &y);
+        if (symmetry & 1)
+            x = Size - 1 - x;
+        if (symmetry & 2)
+            y = Size - 1 - y;
+        if (symmetry & 4)
+            std::swap(x, y);
+        index_t result;
+        cordsToIndex(&result, x, y);
+        return result;
+    }
+
+    /**
+     * Symmetry undoing symmetry
+     * Mirrors applied before a swap act on the other axis afterwards
+    */
+    static uint8_t inverse(const uint8_t symmetry) {
+        if (!(symmetry & 4))
+            return symmetry;
+        return 4 | ((symmetry & 1) << 1) | ((symmetry & 2) >> 1);
+    }
+
+    /**
+     * Symmetry applying first and then second
+     * Found by mapping a field which every symmetry moves elsewhere
+    */
+    static uint8_t compose(const uint8_t first, const uint8_t second) {
+        index_t probe;
+        cordsToIndex(&probe, 0, 1);
+        const index_t target = transform(transform(probe, first), second);
+        uint8_t symmetry = 0;
+        while (transform(probe, symmetry) != target)
+            symmetry++;
+        return symmetry;
     }
 
     static string cellsToString(const vector<vector<string>>& cellValues) {
@@ -68,19 +118,19 @@ class Utils {
 
         output << std::endl;
         output << "   " << corner0;
-        for (int i = 0; i < BOARD_SIZE - 1; i++) {
+        for (int i = 0; i < Size - 1; i++) {
             output << three_lines << cross0;
         }
         output << three_lines << corner1;
         output << endl;
 
         // Inner lines
-        for (int y = BOARD_SIZE - 1; y >= 0; y--) {
+        for (int y = Size - 1; y >= 0; y--) {
             // Data line
             output << to_string(y);
             output << string(3 - to_string(y).length(), ' ');
 
-            for (int x = 0; x < BOARD_SIZE; x++) {
+            for (int x = 0; x < Size; x++) {
                 output << line1;
                 output << cellValues[x][y];
             }
@@ -92,7 +142,7 @@ class Utils {
                 continue;
 
             output << "   " << cross1;
-            for (int i = 0; i < BOARD_SIZE - 1; i++) {
+            for (int i = 0; i < Size - 1; i++) {
                 output << three_lines << center;
             }
             output << three_lines << cross2;
@@ -101,14 +151,14 @@ class Utils {
 
         // Bottom line
         output << "   " << corner2;
-        for (int i = 0; i < BOARD_SIZE - 1; i++) {
+        for (int i = 0; i < Size - 1; i++) {
             output << three_lines << cross3;
         }
         output << three_lines << corner3;
         output << endl;
 
         output << "    ";
-        for (int i = 0; i < BOARD_SIZE; i++) {
+        for (int i = 0; i < Size; i++) {
             output << " ";
             output << to_string(i);
             output << string(3 - to_string(i).length(), ' ');
@@ -118,3 +168,52 @@ class Utils {
         return output.str();
     }
 };
+
+
+/**
+ * Call f.template operator()<Size>() with the compiled in board size
+ * matching size, returns false if there is none
+*/
+template <typename F>
+bool withBoardSize(uint8_t size, F&& f) {
+    #define DISPATCH(SIZE) \
+    if (size == SIZE) { \
+        f.template operator()<SIZE>(); \
+        return true; \
+    }
+    BOARD_SIZES(DISPATCH)
+    #undef DISPATCH
+    return false;
+}
+
+/**
+ * Compiled in board sizes, comma separated
+*/
+inline string boardSizes() {
+    string result;
+    #define LIST(SIZE) result += (result.empty() ? "" : ", ") + to_string(SIZE);
+    BOARD_SIZES(LIST)
+    #undef LIST
+    return result;
+}
+
+/**
+ * Natural logarithm of x > 0, absolute error below 2e-5
+ * Splits off the float exponent and runs a short atanh series
+ * on the mantissa, needs no table and works for any visit count
+*/
+inline float fastLog(float x) {
+    const uint32_t bits = std::bit_cast<uint32_t>(x);
+    const int32_t exponent = static_cast<int32_t>(bits >> 23) - 127;
+
+    // Mantissa in [1, 2)
+    const float m = std::bit_cast<float>((bits & 0x7FFFFF) | 0x3F800000);
+
+    // log(m) = 2 * atanh(t), t in [0, 1/3)
+    const float t = (m - 1) / (m + 1);
+    const float t2 = t * t;
+    const float series = t * (2 + t2 * (2.0f / 3 + t2 * (2.0f / 5 +
+        t2 * (2.0f / 7))));
+
+    return exponent * 0.69314718f + series;
+}
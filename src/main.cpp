@@ -3,51 +3,33 @@
  */
 
 #include <iostream>
-#include <iomanip>
 #include <string>
-#include <sstream>
+#include <atomic>
+#include <cstdlib>
 
 #include <chrono> //NOLINT
 #include <thread> //NOLINT
 
-#include "Randomizer.h"
-#include "Statistics.h"
 #include "State.h"
 #include "Config.h"
 #include "Utilities.h"
-#include "Node.h"
-#include "Dev.h"
+#include "Search.h"
 
 using std::cin;
 using std::cout;
 using std::endl;
 using std::string;
-using std::to_string;
-using std::chrono::system_clock;
-using std::chrono::high_resolution_clock;
-using std::chrono::milliseconds;
 using std::chrono::seconds;
-using std::ostringstream;
+using std::atomic;
 
-void init() {
-    uint32_t seed = system_clock::now().time_since_epoch().count();
-    Randomizer::initialize(seed);
-    State::initZobrist();
-    Node::initLogTable();
-    Node::reserveTT(MAX_SIMULATIONS);
-
-    #ifdef RAVE
-    Node::resetRave();
-    #endif
-}
-
-void human_move(State* state) {
+template <uint8_t Size>
+void human_move(State<Size>* state) {
     bool getting_input = true;
     string input_x;
     string input_y;
     uint8_t x;
     uint8_t y;
-    index_t index;
+    Index<Size> index;
     std::cout << "\n";
     while (getting_input) {
         try {
@@ -63,7 +45,7 @@ void human_move(State* state) {
             continue;
         }
 
-        if ((0 <= x && x < BOARD_SIZE) && (0 <= y && y < BOARD_SIZE)) {
+        if ((0 <= x && x < Size) && (0 <= y && y < Size)) {
             if (state->isEmpty(x, y))
                 getting_input = false;
             else
@@ -73,101 +55,54 @@ void human_move(State* state) {
         }
     }
 
-    Utils::cordsToIndex(&index, x, y);
+    Utils<Size>::cordsToIndex(&index, x, y);
     state->action(index);
 }
 
-void deleteTreeBackground(Node* root) {
-    std::thread([root]() {
-        Node::deleteTree(root);
-    }).detach();
-}
-
-void MCTS_master(Node* root, State *root_state) {
-    // Select best child
-    Node* best = root->absBestChild();
-
-    #ifdef ANALYTICS
-    // Print visits distribution
-    Analytics::visitsDist(root);
-
-    // Print evaluation distribution
-    Analytics::ucbDist(root);
-
-    // Print Rave distribution
-    #ifdef RAVE
-    Analytics::raveDist(root);
-    #endif
-
-    // Print overview
-    Analytics::overview(best);
-    #endif
-
-    (*root_state).action(best->getParentAction());
-
-    // Reset TT
-    Node::reset();
-}
-
-void MCTS_move(State *root_state, uint64_t simulations) {
-    if (simulations > MAX_SIMULATIONS)
-        throw std::invalid_argument("Simulations must be less than " +
-            to_string(MAX_SIMULATIONS) + "!");
-
-    Node* root = new Node(*root_state);
-    // Build Tree
-    for (uint64_t i = 0; i < simulations; i++) {
-        Node* node = root->policy();
-        node->rollout();
-    }
-
-    MCTS_master(root, root_state);
-    deleteTreeBackground(root);
-}
-
-void MCTS_move(State *root_state, milliseconds time) {
-    Node* root = new Node(*root_state);
-
-    // How many simulations to run before checking time
-    const int32_t batchSize = 1000;
-
-    // Build Tree
-    uint32_t i;
-    uint32_t iterations = 0;
-
-    auto start = high_resolution_clock::now();
-    while (high_resolution_clock::now() - start < time) {
-        for (i = 0; i < batchSize; i++) {
-            Node* node = root->policy();
-            node->rollout();
-        }
-
-        iterations++;
-
-        if ((iterations + 1) * batchSize > MAX_SIMULATIONS) {
-            printf("Exiting due to MAX_SIMULATIONS! -> Increase in Config.h\n");
-            break;
-        }
-    }
-
-    MCTS_master(root, root_state);
-    deleteTreeBackground(root);
-}
-
-int main() {
-    init();
-    State state = State();
+/**
+ * Play a game against the engine on a board of Size
+*/
+template <uint8_t Size>
+void play() {
+    initBoard<Size>();
+    MCTS_openBook<Size>();
+    State<Size> state = State<Size>();
     cout << state.toString();
 
     const seconds aiTime = seconds(10);
 
     while (!state.terminal()) {
-        if (!(state.getEmpty() % 2))
+        if (!(state.getEmpty() % 2)) {
             MCTS_move(&state, aiTime);
-        else
+        } else {
+            #ifdef PONDER
+            atomic<bool> stop = false;
+            std::thread ponder = MCTS_ponder<Size>(stop);
+            human_move(&state);
+            stop = true;
+            ponder.join();
+            #else
             human_move(&state);
+            #endif
+        }
         cout << state.toString();
     }
 
     cout << "Result: " << static_cast<int>(state.getResult()) << endl;
 }
+
+int main(int argc, char** argv) {
+    init();
+
+    // Optional board size argument
+    const int size = argc > 1 ? atoi(argv[1]) : BOARD_SIZE;
+
+    const bool supported = 0 < size && size < 64 &&
+        withBoardSize(size, []<uint8_t Size>() { play<Size>(); });
+
+    if (!supported) {
+        cout << "Unsupported board size " << size
+            << "! Compiled sizes: " << boardSizes() << endl;
+        return 1;
+    }
+}